@@ -0,0 +1,386 @@
+/**
+ * @file midi_codec.h
+ * @brief Table driven conversion between MIDI byte streams and USB MIDI
+ * event packets. Include this file in the implementation for the host
+ * and the device Pico
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+namespace rppicomidi {
+// 256-entry lookup tables indexed by MIDI status byte
+struct Midi_codec_table {
+    uint8_t value[256];
+};
+constexpr Midi_codec_table make_midi_length_table() {
+    Midi_codec_table table{};
+    for (int status = 0x80; status < 0x100; status++) {
+        uint8_t length = 1; // tune request, EOX, undefined system common and real-time
+        if (status < 0xF0) {
+            uint8_t type = status & 0xF0;
+            length = (type == 0xC0 || type == 0xD0) ? 2 : 3;
+        }
+        else if (status == 0xF0) {
+            length = 0;
+        }
+        else if (status == 0xF1 || status == 0xF3) {
+            length = 2; // MTC Quarter Frame or Song Select
+        }
+        else if (status == 0xF2) {
+            length = 3; // Song Position Pointer
+        }
+        table.value[status] = length;
+    }
+    return table;
+}
+constexpr Midi_codec_table make_midi_cin_table() {
+    Midi_codec_table table{};
+    for (int status = 0x80; status < 0x100; status++) {
+        uint8_t cin = 0xF; // single byte
+        if (status < 0xF0) {
+            cin = status >> 4; // channel message CIN is the message type
+        }
+        else if (status == 0xF0) {
+            cin = 0x4; // sysex start or continue
+        }
+        else if (status == 0xF1 || status == 0xF3) {
+            cin = 0x2; // 2-byte system common
+        }
+        else if (status == 0xF2) {
+            cin = 0x3; // 3-byte system common
+        }
+        else if (status < 0xF8) {
+            cin = 0x5; // single-byte system common or EOX
+        }
+        table.value[status] = cin;
+    }
+    return table;
+}
+inline constexpr Midi_codec_table midi_length_table = make_midi_length_table();
+inline constexpr Midi_codec_table midi_cin_table = make_midi_cin_table();
+
+class Midi_codec
+{
+public:
+    /**
+     * @brief the number of bytes in a message by status byte
+     *
+     * 0 for data bytes and for 0xF0 (the length of a system exclusive
+     * message is not known until the 0xF7 EOX byte)
+     */
+    static constexpr uint8_t message_length(uint8_t status) { return midi_length_table.value[status]; }
+
+    /**
+     * @brief the USB MIDI Code Index Number (CIN) of a complete message by status byte.
+     * 0xF0 maps to the sysex start or continue CIN; data bytes map to 0.
+     */
+    static constexpr uint8_t code_index(uint8_t status) { return midi_cin_table.value[status]; }
+
+    /**
+     * @brief the USB MIDI Code Index Number of the packet that ends
+     * a system exclusive message
+     *
+     * @param nbytes the number of bytes in the packet including the 0xF7 EOX 1-3
+     */
+    static constexpr uint8_t sysex_end_code_index(uint8_t nbytes) { return 0x4 + nbytes; }
+
+    /**
+     * @brief Convert a MIDI byte stream into USB MIDI event packets.
+     * Use one instance per virtual cable.
+     */
+    class Packetizer
+    {
+    public:
+        constexpr Packetizer() : packet{0,0,0,0}, idx{0}, size{0}, in_sysex{false}, running_status{0}, ndropped{0} {}
+
+        /**
+         * @brief add one byte of the stream
+         *
+         * Real-time messages are returned as soon as they arrive, even
+         * in the middle of another message. Channel messages may use
+         * running status.
+         * @param cable the virtual cable number 0-15 of the stream
+         * @param byte the next byte of the stream
+         * @param out_packet the 4-byte packet if the return value is true
+         * @return true if out_packet contains a complete packet
+         */
+        constexpr bool push(uint8_t cable, uint8_t byte, uint8_t* out_packet) {
+            uint8_t const header = cable << 4;
+            if (byte >= 0xF8) {
+                // real-time message
+                out_packet[0] = header | code_index(byte);
+                out_packet[1] = byte;
+                out_packet[2] = 0;
+                out_packet[3] = 0;
+                return true;
+            }
+            if (byte == 0xF7) {
+                if (!in_sysex || idx == 0) {
+                    // stray EOX or EOX at the start of a packet; send it on by itself
+                    idx = 1;
+                }
+                in_sysex = false;
+                running_status = 0;
+                packet[idx] = byte;
+                packet[0] = header | sysex_end_code_index(idx);
+                ++idx;
+                return complete(out_packet);
+            }
+            if (byte & 0x80) {
+                // new status byte. Any message in progress is incomplete
+                in_sysex = byte == 0xF0;
+                // system common messages cancel running status
+                running_status = byte < 0xF0 ? byte : 0;
+                size = in_sysex ? 4 : message_length(byte) + 1;
+                packet[0] = header | code_index(byte);
+                packet[1] = byte;
+                idx = 2;
+                if (idx >= size) {
+                    // single byte system common message
+                    return complete(out_packet);
+                }
+                return false;
+            }
+            if (idx == 0 && in_sysex) {
+                // sysex continues in a new packet
+                idx = 1;
+                size = 4;
+                packet[0] = header | code_index(0xF0);
+            }
+            else if (idx == 0 && running_status != 0) {
+                // running status: the data byte starts a new message
+                packet[0] = header | code_index(running_status);
+                packet[1] = running_status;
+                idx = 2;
+                size = message_length(running_status) + 1;
+            }
+            if (idx == 0 || idx >= size) {
+                ++ndropped;
+                return false; // data byte without a status byte
+            }
+            packet[idx++] = byte;
+            if (idx >= size) {
+                return complete(out_packet);
+            }
+            return false;
+        }
+
+        /**
+         * @brief get the number of data bytes dropped because they
+         * were not part of a message
+         */
+        constexpr uint32_t get_num_dropped() const { return ndropped; }
+    private:
+        constexpr bool complete(uint8_t* out_packet) {
+            for (uint8_t jdx = idx; jdx < 4; jdx++)
+                packet[jdx] = 0;
+            for (uint8_t jdx = 0; jdx < 4; jdx++)
+                out_packet[jdx] = packet[jdx];
+            idx = 0;
+            return true;
+        }
+        uint8_t packet[4];
+        uint8_t idx;        // index in packet where the next byte goes; 0 if no message in progress
+        uint8_t size;       // number of bytes in packet when it is complete
+        bool in_sysex;
+        uint8_t running_status; // the last channel message status byte or 0
+        uint32_t ndropped;
+    };
+
+    /**
+     * @brief the number of MIDI bytes in a USB MIDI packet by Code Index Number
+     */
+    static constexpr uint8_t packet_length(uint8_t cin) {
+        constexpr uint8_t cin_lengths[16] = {0, 0, 2, 3, 3, 1, 2, 3, 3, 3, 3, 3, 2, 2, 3, 1};
+        return cin_lengths[cin & 0xF];
+    }
+
+    /**
+     * @brief Remove status bytes from a MIDI byte stream where running status allows.
+     * Use one instance per virtual cable.
+     */
+    class Running_status_encoder
+    {
+    public:
+        constexpr Running_status_encoder() : running_status{0} {}
+
+        /**
+         * @brief encode part of the stream
+         *
+         * @param bytes the next bytes of the stream
+         * @param nbytes the number of bytes
+         * @param out the encoded bytes; must have room for nbytes bytes
+         * @return the number of bytes in out
+         */
+        constexpr uint8_t encode(const uint8_t* bytes, uint8_t nbytes, uint8_t* out) {
+            uint8_t nout = 0;
+            for (uint8_t idx = 0; idx < nbytes; idx++) {
+                uint8_t byte = bytes[idx];
+                if (byte >= 0xF8) {
+                    // real-time messages do not affect running status
+                }
+                else if (byte >= 0xF0) {
+                    running_status = 0;
+                }
+                else if (byte & 0x80) {
+                    if (byte == running_status)
+                        continue; // same status as the previous channel message
+                    running_status = byte;
+                }
+                out[nout++] = byte;
+            }
+            return nout;
+        }
+
+        /**
+         * @brief force the next channel message to include its status byte.
+         * Call if encoded bytes could not be sent.
+         */
+        void reset() { running_status = 0; }
+    private:
+        uint8_t running_status;
+    };
+
+    /**
+     * @brief Get the number of MIDI bytes in a USB MIDI event packet
+     *
+     * The CIN is ignored because some products do not set it correctly;
+     * the length comes from the status byte or, for system exclusive data,
+     * from the position of the EOX byte.
+     * @param packet the 4-byte USB MIDI event packet
+     * @param in_sysex true if a system exclusive message is in progress on the
+     * packet's virtual cable. Updated by this function.
+     * @return the number of bytes starting at packet[1]; 0 if the packet is poorly formed
+     */
+    static constexpr uint8_t depacketize(const uint8_t* packet, bool& in_sysex) {
+        uint8_t const status = packet[1];
+        if (status == 0xF0 || (status < 0x80 && in_sysex)) {
+            in_sysex = true;
+            if (packet[2] == 0xF7) {
+                in_sysex = false;
+                return 2;
+            }
+            if (packet[3] == 0xF7) {
+                in_sysex = false;
+            }
+            return 3;
+        }
+        if (status < 0xF8) {
+            // real-time messages may be in the middle of a sysex message
+            in_sysex = false;
+        }
+        return message_length(status);
+    }
+};
+
+// The tables are checked when the code is compiled
+static_assert(Midi_codec::message_length(0x90) == 3 && Midi_codec::message_length(0xC5) == 2 && Midi_codec::message_length(0xDF) == 2);
+static_assert(Midi_codec::message_length(0xE8) == 3 && Midi_codec::message_length(0xF0) == 0 && Midi_codec::message_length(0xF1) == 2);
+static_assert(Midi_codec::message_length(0xF2) == 3 && Midi_codec::message_length(0xF6) == 1 && Midi_codec::message_length(0xF8) == 1);
+static_assert(Midi_codec::message_length(0x40) == 0);
+static_assert(Midi_codec::code_index(0x90) == 0x9 && Midi_codec::code_index(0xD3) == 0xD && Midi_codec::code_index(0xF0) == 0x4);
+static_assert(Midi_codec::code_index(0xF1) == 0x2 && Midi_codec::code_index(0xF2) == 0x3 && Midi_codec::code_index(0xF6) == 0x5);
+static_assert(Midi_codec::code_index(0xFE) == 0xF && Midi_codec::sysex_end_code_index(1) == 0x5 && Midi_codec::sysex_end_code_index(3) == 0x7);
+
+// The packet conversions are checked when the code is compiled
+namespace midi_codec_check {
+struct Packets {
+    uint8_t value[8][4];
+    uint8_t count;
+    uint32_t ndropped;
+};
+
+template<size_t N>
+constexpr Packets packetize(uint8_t cable, const uint8_t (&bytes)[N]) {
+    Packets packets{};
+    Midi_codec::Packetizer packetizer;
+    for (size_t idx = 0; idx < N; idx++) {
+        if (packetizer.push(cable, bytes[idx], packets.value[packets.count]))
+            ++packets.count;
+    }
+    packets.ndropped = packetizer.get_num_dropped();
+    return packets;
+}
+
+constexpr bool packet_is(const Packets& packets, uint8_t idx, uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) {
+    return idx < packets.count && packets.value[idx][0] == b0 && packets.value[idx][1] == b1 &&
+        packets.value[idx][2] == b2 && packets.value[idx][3] == b3;
+}
+
+template<size_t N>
+constexpr uint8_t depacketize_length(const uint8_t (&packet)[N], bool in_sysex, bool expect_in_sysex) {
+    uint8_t nbytes = Midi_codec::depacketize(packet, in_sysex);
+    return in_sysex == expect_in_sysex ? nbytes : 0xFF;
+}
+
+template<size_t N, size_t M>
+constexpr bool encodes_to(const uint8_t (&bytes)[N], const uint8_t (&expected)[M]) {
+    uint8_t out[N]{};
+    Midi_codec::Running_status_encoder encoder;
+    if (encoder.encode(bytes, N, out) != M)
+        return false;
+    for (size_t idx = 0; idx < M; idx++) {
+        if (out[idx] != expected[idx])
+            return false;
+    }
+    return true;
+}
+
+// running status on cable 1
+constexpr Packets running_status = packetize(1, {0x90, 0x3C, 0x7F, 0x3E, 0x7F});
+static_assert(running_status.count == 2 && packet_is(running_status, 0, 0x19, 0x90, 0x3C, 0x7F) &&
+    packet_is(running_status, 1, 0x19, 0x90, 0x3E, 0x7F));
+// real-time bytes do not cancel running status; system common bytes do
+constexpr Packets running_status_rt = packetize(0, {0x90, 0x3C, 0xF8, 0x7F, 0x3E, 0x7F, 0xF6, 0x3E});
+static_assert(running_status_rt.count == 4 && packet_is(running_status_rt, 0, 0x0F, 0xF8, 0x00, 0x00) &&
+    packet_is(running_status_rt, 1, 0x09, 0x90, 0x3C, 0x7F) && packet_is(running_status_rt, 2, 0x09, 0x90, 0x3E, 0x7F) &&
+    packet_is(running_status_rt, 3, 0x05, 0xF6, 0x00, 0x00) && running_status_rt.ndropped == 1);
+// a real-time byte inside sysex goes out first and the sysex continues around it
+constexpr Packets sysex_rt = packetize(0, {0xF0, 0x00, 0xF8, 0x00, 0x66, 0xF7});
+static_assert(sysex_rt.count == 3 && packet_is(sysex_rt, 0, 0x0F, 0xF8, 0x00, 0x00) &&
+    packet_is(sysex_rt, 1, 0x04, 0xF0, 0x00, 0x00) && packet_is(sysex_rt, 2, 0x06, 0x66, 0xF7, 0x00));
+// sysex split across packets, ending with 3 bytes and with the EOX alone
+constexpr Packets sysex_split = packetize(0, {0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7, 0xF0, 0x01, 0x02, 0xF7});
+static_assert(sysex_split.count == 4 && packet_is(sysex_split, 0, 0x04, 0xF0, 0x7E, 0x7F) &&
+    packet_is(sysex_split, 1, 0x07, 0x06, 0x01, 0xF7) && packet_is(sysex_split, 2, 0x04, 0xF0, 0x01, 0x02) &&
+    packet_is(sysex_split, 3, 0x05, 0xF7, 0x00, 0x00));
+
+// sysex split across packets, and a real-time packet inside sysex
+static_assert(depacketize_length({0x04, 0xF0, 0x7E, 0x7F}, false, true) == 3);
+static_assert(depacketize_length({0x04, 0x06, 0x01, 0x02}, true, true) == 3);
+static_assert(depacketize_length({0x07, 0x06, 0x01, 0xF7}, true, false) == 3);
+static_assert(depacketize_length({0x06, 0x66, 0xF7, 0x00}, true, false) == 2);
+static_assert(depacketize_length({0x05, 0xF7, 0x00, 0x00}, true, false) == 1);
+static_assert(depacketize_length({0x0F, 0xF8, 0x00, 0x00}, true, true) == 1);
+static_assert(depacketize_length({0x09, 0x90, 0x3C, 0x7F}, true, false) == 3);
+
+// the encoder drops repeated status bytes, keeps them around real-time
+// bytes and sends them again after system common or sysex
+static_assert(encodes_to({0x90, 0x3C, 0x7F, 0x90, 0x3E, 0x7F, 0xF8, 0x90, 0x40, 0x7F},
+    {0x90, 0x3C, 0x7F, 0x3E, 0x7F, 0xF8, 0x40, 0x7F}));
+static_assert(encodes_to({0x90, 0x3C, 0x7F, 0xF0, 0x01, 0xF7, 0x90, 0x3E, 0x7F},
+    {0x90, 0x3C, 0x7F, 0xF0, 0x01, 0xF7, 0x90, 0x3E, 0x7F}));
+}
+}
@@ -0,0 +1,84 @@
+/**
+ * @file midi_uart_tx.h
+ * @brief Send MIDI to the other Pico over the UART, optionally using
+ * running status. Include this file in the implementation for the host
+ * and the device Pico
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#pragma once
+#include <cstdint>
+#include "pico_pico_midi_lib.h"
+#include "midi_codec.h"
+
+// Set to 1 in both the host and the device builds to remove status bytes
+// that running status makes redundant on the UART link. Both Picos decode
+// running status regardless of this setting.
+#ifndef MIDI_UART_RUNNING_STATUS
+#define MIDI_UART_RUNNING_STATUS 0
+#endif
+
+namespace rppicomidi {
+class Midi_uart_tx
+{
+public:
+    // Singleton Pattern so all senders on a cable share the running status state
+    static Midi_uart_tx& instance()
+    {
+        static Midi_uart_tx _instance; // Guaranteed to be destroyed.
+                                        // Instantiated on first use.
+        return _instance;
+    }
+    Midi_uart_tx(Midi_uart_tx const&) = delete;
+    void operator=(Midi_uart_tx const&) = delete;
+
+    /**
+     * @brief write MIDI bytes to the UART transmit buffer
+     *
+     * @param bytes the MIDI byte stream for the cable
+     * @param nbytes the number of bytes
+     * @param cable_num the virtual cable number 0-15
+     * @return the number of bytes from bytes written; if less than nbytes, the rest were dropped
+     */
+    uint8_t write(const uint8_t* bytes, uint8_t nbytes, uint8_t cable_num) {
+#if MIDI_UART_RUNNING_STATUS
+        uint8_t encoded[256];
+        uint8_t nencoded = encoders[cable_num & 0xf].encode(bytes, nbytes, encoded);
+        uint8_t npushed = Pico_pico_midi_lib::instance().write_midi_to_tx_buffer(encoded, nencoded, cable_num);
+        if (npushed != nencoded) {
+            // the receiver's running status is no longer known
+            encoders[cable_num & 0xf].reset();
+            return nbytes - (nencoded - npushed);
+        }
+        return nbytes;
+#else
+        return Pico_pico_midi_lib::instance().write_midi_to_tx_buffer(const_cast<uint8_t*>(bytes), nbytes, cable_num);
+#endif
+    }
+private:
+    Midi_uart_tx() = default;
+#if MIDI_UART_RUNNING_STATUS
+    Midi_codec::Running_status_encoder encoders[16];
+#endif
+};
+}
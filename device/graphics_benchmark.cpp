@@ -0,0 +1,152 @@
+/**
+ * @file graphics_benchmark.cpp
+ * @brief Measure the drawing speed of the Mono_graphics primitives that
+ * the channel strip and timecode displays use, for each screen rotation,
+ * and the VPot LED ring update (see Mc_vpot_display::run_benchmark()).
+ * The results print on the UART stdio port. The benchmark uses the
+ * timecode OLED wiring. It only measures the primitives as the
+ * mono graphics library implements them; it does not change them.
+ * Its results are the baseline for per-rotation word-wide fill, clear,
+ * hline, vline and blit kernels and a word memset clear_canvas(),
+ * which belong in Mono_graphics in the pico-ssd1306-mono-graphics-lib
+ * submodule.
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+
+#include <cstdio>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "mono_graphics_lib.h"
+#include "ssd1306i2c.h"
+#include "ssd1306.h"
+#include "mc_vpot_display.h"
+
+namespace rppicomidi {
+class Graphics_benchmark
+{
+public:
+    Graphics_benchmark(Ssd1306& ssd1306_) : ssd1306{ssd1306_} {}
+
+    /**
+     * @brief time each primitive on a screen with the given rotation and
+     * print the pixels drawn per microsecond
+     */
+    void run(Display_rotation rotation, const char* rotation_name);
+private:
+    static const uint32_t nreps = 200;
+    /**
+     * @brief print one result line
+     *
+     * @param primitive the name of the primitive
+     * @param pixels the number of pixels the primitive draws each repetition
+     * @param elapsed_us the time for nreps repetitions
+     */
+    void report(const char* rotation_name, const char* primitive, uint32_t pixels, uint64_t elapsed_us);
+    Ssd1306& ssd1306;
+};
+}
+
+void rppicomidi::Graphics_benchmark::report(const char* rotation_name, const char* primitive, uint32_t pixels, uint64_t elapsed_us)
+{
+    if (elapsed_us == 0)
+        elapsed_us = 1;
+    uint32_t pixels_per_ms = (uint32_t)((uint64_t)pixels * nreps * 1000 / elapsed_us);
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    printf("%-13s %-22s %4lu.%03lu pixels/us %6lu cycles/call\r\n", rotation_name, primitive,
+        pixels_per_ms / 1000, pixels_per_ms % 1000, (uint32_t)(elapsed_us * mhz / nreps));
+}
+
+void rppicomidi::Graphics_benchmark::run(Display_rotation rotation, const char* rotation_name)
+{
+    Mono_graphics screen{&ssd1306, rotation};
+    int width = screen.get_screen_width();
+    int height = screen.get_screen_height();
+    const Mono_mono_font& font = screen.get_font_8();
+    uint64_t start;
+
+    start = time_us_64();
+    for (uint32_t rep = 0; rep < nreps; rep++)
+        screen.clear_canvas();
+    report(rotation_name, "clear_canvas", width*height, time_us_64() - start);
+
+    start = time_us_64();
+    for (uint32_t rep = 0; rep < nreps; rep++)
+        screen.draw_rectangle(0, 0, width, height, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE);
+    report(rotation_name, "fill screen", width*height, time_us_64() - start);
+
+    start = time_us_64();
+    for (uint32_t rep = 0; rep < nreps; rep++)
+        screen.draw_rectangle(1, 1, 6, 6, Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
+    report(rotation_name, "fill 6x6 (meter)", 36, time_us_64() - start);
+
+    start = time_us_64();
+    for (uint32_t rep = 0; rep < nreps; rep++)
+        screen.draw_line(0, rep % height, width-1, rep % height, Pixel_state::PIXEL_ZERO);
+    report(rotation_name, "horizontal line", width, time_us_64() - start);
+
+    start = time_us_64();
+    for (uint32_t rep = 0; rep < nreps; rep++)
+        screen.draw_line(rep % width, 0, rep % width, height-1, Pixel_state::PIXEL_ONE);
+    report(rotation_name, "vertical line", height, time_us_64() - start);
+
+    start = time_us_64();
+    for (uint32_t rep = 0; rep < nreps; rep++)
+        screen.draw_centered_circle(width/2, height/2, 3, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE);
+    report(rotation_name, "circle r=3 (VPot LED)", 7*7, time_us_64() - start);
+
+    start = time_us_64();
+    for (uint32_t rep = 0; rep < nreps; rep++)
+        screen.draw_character(font, 0, 0, 'A' + rep % 26, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+    report(rotation_name, "character (font 8)", font.width*font.height, time_us_64() - start);
+
+    start = time_us_64();
+    for (uint32_t rep = 0; rep < nreps; rep++)
+        screen.draw_string(font, 0, font.height, "Ch 1   ", 7, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+    report(rotation_name, "7 characters (font 8)", 7*font.width*font.height, time_us_64() - start);
+}
+
+int main()
+{
+    using namespace rppicomidi;
+    stdio_init_all();
+    sleep_ms(2000); // give a terminal time to connect
+    uint8_t addr[1] = {0x3c};
+    Ssd1306i2c i2c_driver{i2c1, addr, 2, 3, sizeof(addr), 0, nullptr};
+    Ssd1306 ssd1306{&i2c_driver, 0, Ssd1306::Com_pin_cfg::ALT_DIS, 128, 64, 0, 0};
+    Graphics_benchmark benchmark{ssd1306};
+    while (1) {
+        printf("Mono_graphics benchmark: %lu MHz\r\n", clock_get_hz(clk_sys) / 1000000);
+        benchmark.run(Display_rotation::Landscape0, "Landscape0");
+        benchmark.run(Display_rotation::Portrait90, "Portrait90");
+        benchmark.run(Display_rotation::Landscape180, "Landscape180");
+        benchmark.run(Display_rotation::Portrait270, "Portrait270");
+        {
+            // the channel strip screens use Portrait270
+            Mono_graphics screen{&ssd1306, Display_rotation::Portrait270};
+            Mc_vpot_display::run_benchmark(screen);
+        }
+        sleep_ms(10000);
+    }
+    return 0;
+}
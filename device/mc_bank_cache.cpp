@@ -0,0 +1,78 @@
+/**
+ * @file mc_bank_cache.cpp
+ * @brief This class keeps snapshots of the channel strip state of the
+ * most recently used Mackie Control banks
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#include <cstring>
+#include "mc_bank_cache.h"
+
+rppicomidi::Mc_bank_cache::Mc_bank_cache() : use_count{0}
+{
+    for (auto& entry: entries) {
+        entry.valid = false;
+    }
+}
+
+bool rppicomidi::Mc_bank_cache::is_blank(const uint8_t* name)
+{
+    for (uint8_t idx = 0; idx < name_length; idx++) {
+        if (name[idx] != ' ' && name[idx] < 0x80)
+            return false;
+    }
+    return true;
+}
+
+void rppicomidi::Mc_bank_cache::save(const uint8_t* name, const Snapshot& snapshot)
+{
+    if (is_blank(name))
+        return; // banks of empty tracks can't be told apart
+    Entry* lru = &entries[0];
+    for (auto& entry: entries) {
+        if (entry.valid && memcmp(entry.name, name, name_length) == 0) {
+            lru = &entry;
+            break;
+        }
+        if (!entry.valid || (lru->valid && entry.last_used < lru->last_used)) {
+            lru = &entry;
+        }
+    }
+    lru->valid = true;
+    memcpy(lru->name, name, name_length);
+    lru->last_used = ++use_count;
+    lru->snapshot = snapshot;
+}
+
+const rppicomidi::Mc_bank_cache::Snapshot* rppicomidi::Mc_bank_cache::find(const uint8_t* name)
+{
+    if (is_blank(name))
+        return nullptr;
+    for (auto& entry: entries) {
+        if (entry.valid && memcmp(entry.name, name, name_length) == 0) {
+            entry.last_used = ++use_count;
+            return &entry.snapshot;
+        }
+    }
+    return nullptr;
+}
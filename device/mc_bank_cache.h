@@ -0,0 +1,79 @@
+/**
+ * @file mc_bank_cache.h
+ * @brief This class keeps snapshots of the channel strip state of the
+ * most recently used Mackie Control banks
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#pragma once
+#include <cstdint>
+namespace rppicomidi {
+class Mc_bank_cache
+{
+public:
+    /**
+     * @brief The state of the 8 channel strips of one MC unit
+     */
+    struct Snapshot {
+        uint8_t vpot[8];    // the VPot LED ring CC values
+        uint8_t leds[8];    // the REC, SOLO, MUTE and SEL LED bits
+    };
+
+    static const uint8_t name_length = 7;
+
+    Mc_bank_cache();
+
+    /**
+     * @brief store the snapshot of a bank, replacing the
+     * least recently used snapshot if the cache is full
+     *
+     * @param name the name of the first track of the bank: the first
+     * name_length characters of the top LCD line. Blank names are not cached.
+     * @param snapshot the state of the channel strips
+     */
+    void save(const uint8_t* name, const Snapshot& snapshot);
+
+    /**
+     * @brief find the snapshot of a bank and mark it most recently used
+     *
+     * @param name the name of the first track of the bank (see save())
+     * @return a pointer to the snapshot or nullptr if the bank is not cached
+     */
+    const Snapshot* find(const uint8_t* name);
+
+    static const uint8_t num_entries = 4;
+private:
+    struct Entry {
+        bool valid;
+        uint8_t name[name_length];
+        uint32_t last_used; // the value of use_count when the entry was last saved or found
+        Snapshot snapshot;
+    };
+    /**
+     * @brief true if the name is all spaces or unknown characters
+     */
+    static bool is_blank(const uint8_t* name);
+    Entry entries[num_entries];
+    uint32_t use_count;
+};
+}
@@ -47,12 +47,20 @@
 #include "class/midi/midi_device.h"
 #include "usb_descriptors.h"
 #include "../common/pico-mc-display-bridge-cmds.h"
+#include "../common/midi_codec.h"
+#include "../common/midi_uart_tx.h"
 #include "settings_file.h"
 #include "view_manager.h"
 #include "midi_processor_manager.h"
 #include "midi_processor_home_screen.h"
 #include "midi_processor_mc_display.h"
+#include "midi_processor_flood_thin.h"
+#include "midi_processor_flood_thin_view.h"
+#include "midi_processor_chain_monitor.h"
 #include "midi_processor_no_settings_view.h"
+#if MIDI_OUT_DEDUP
+#include "midi_out_dedup.h"
+#endif
 // On-board LED mapping. If no LED, set to NO_LED_GPIO
 const uint NO_LED_GPIO = 255;
 const uint LED_GPIO = 25;
@@ -90,11 +98,7 @@ public:
     Pico_mc_display_bridge_dev();
     void task();
     uint8_t serial_number[7];
-    static struct Rx_packet {
-        uint8_t packet[4];
-        uint8_t idx;
-        uint8_t size;
-    } rx_packet[16]; // rx_packet[cbl] is the currently decoded packet for cable number cbl 0-15
+    static Midi_codec::Packetizer rx_packetizer[16]; // rx_packetizer[cbl] decodes the UART MIDI stream for cable number cbl 0-15
     static void midi_cb(uint8_t *buffer, uint8_t buflen, uint8_t cable_num);
     static void static_cmd_cb(uint8_t header, uint8_t* buffer, uint16_t length);
     static void static_err_cb(uint8_t header, uint8_t* buffer, uint16_t length);
@@ -103,12 +107,48 @@ public:
     void cmd_cb(uint8_t header, uint8_t* buffer, uint16_t length);
     void err_cb(uint8_t header, uint8_t* buffer, uint16_t length);
     void poll_usb_rx(bool connected);
+    static const size_t usb_rx_batch_size = CFG_TUD_MIDI_RX_BUFSIZE / 4; // the USB MIDI RX FIFO size in packets
     void poll_midi_uart_rx(bool connected);
     bool handle_mc_device_inquiry();
     void push_to_midi_uart(uint8_t* bytes, int nbytes, uint8_t cable_num);
     void push_to_midi_uart(uint8_t* packet, uint8_t cable_num);
+    bool uart_in_sysex[16]; // uart_in_sysex[cbl] is true if a sysex message is in progress on cable cbl 0-15
     void request_dev_desc();
+    /**
+     * @brief periodically log the number of channel strip draws
+     * avoided by drawing changes once per render cycle
+     */
+    void log_draw_statistics();
+    /**
+     * @brief consume the damage list of a channel strip after its changes are drawn
+     *
+     * @param chan the channel strip index
+     * @return true if the screen buffer changed and needs to be rendered
+     */
+    bool consume_damage(uint8_t chan);
+    uint32_t ndamaged_pixels;   // the sum of the channel strip damage list areas
+    uint32_t nrendered_pixels;  // the number of channel strip screen pixels rendered
+    uint32_t nrenders_skipped;  // the number of channel strip renders skipped because nothing changed
+    /**
+     * @brief recompute the bitmaps of cables that have no MIDI processors.
+     * Call only when Midi_processor_chain_monitor reports a change.
+     */
+    void update_bypass_bitmaps();
+    uint16_t midi_in_bypass;  // bit cbl is set if MIDI IN cable cbl has no MIDI processors
+    uint16_t midi_out_bypass; // bit cbl is set if MIDI OUT cable cbl has no MIDI processors
+#if MIDI_OUT_DEDUP
+    Midi_out_dedup midi_out_dedup;
+#endif
     static void static_handle_set_mc_cable(uint8_t cable_, void* context_);
+    /**
+     * @brief send a packet Flood Thin held back to the DAW after the MIDI IN
+     * processors that follow it in the chain
+     *
+     * @param packet the USB MIDI packet
+     * @param proc the Flood Thin processor that held the packet back
+     * @return false if the packet could not be sent now
+     */
+    static bool static_send_held_midi_in(uint8_t* packet, Midi_processor* proc, void* context_);
     const uint NO_LED_GPIO=255;
     const uint LED_GPIO=25;
     const uint8_t OLED_ADDR=0x3c;
@@ -199,7 +239,7 @@ public:
 };
 }
 
-rppicomidi::Pico_mc_display_bridge_dev::Rx_packet rppicomidi::Pico_mc_display_bridge_dev::rx_packet[16];
+rppicomidi::Midi_codec::Packetizer rppicomidi::Pico_mc_display_bridge_dev::rx_packetizer[16];
 
 static void blink_led(void)
 {
@@ -256,8 +296,13 @@ rppicomidi::Pico_mc_display_bridge_dev::Pico_mc_display_bridge_dev()  : addr{OLE
     gpio_init(LED_GPIO);
     gpio_set_dir(LED_GPIO, GPIO_OUT);
     Pico_pico_midi_lib::instance().init(nullptr, static_cmd_cb, static_err_cb);
-    memset(rx_packet, 0, sizeof(rx_packet));
+    memset(uart_in_sysex, 0, sizeof(uart_in_sysex));
     render_done_mask = 0;
+    midi_in_bypass = 0;
+    midi_out_bypass = 0;
+    ndamaged_pixels = 0;
+    nrendered_pixels = 0;
+    nrenders_skipped = 0;
 
     uint16_t target_done_mask = ((1<<(num_chan_displays)) -1) |(1<<8);
     bool success = true;
@@ -280,6 +325,9 @@ rppicomidi::Pico_mc_display_bridge_dev::Pico_mc_display_bridge_dev()  : addr{OLE
     Midi_processor_manager::instance().set_screen(&screen_tc);
     Midi_processor_manager::instance().add_new_processor_type(Midi_processor_mc_display::static_getname(), Midi_processor_mc_display::static_make_new,
                                                               Midi_processor_no_settings_view::static_make_new);
+    Midi_processor_flood_thin_core::instance().register_send_callback(static_send_held_midi_in, this);
+    Midi_processor_manager::instance().add_new_processor_type(Midi_processor_flood_thin::static_getname(), Midi_processor_flood_thin::static_make_new,
+                                                              Midi_processor_flood_thin_view::static_make_new);
 }
 
 void rppicomidi::Pico_mc_display_bridge_dev::static_cmd_cb(uint8_t header, uint8_t* payload_, uint16_t length_)
@@ -401,6 +449,7 @@ void rppicomidi::Pico_mc_display_bridge_dev::cmd_cb(uint8_t header, uint8_t* pay
                         if (!Settings_file::instance().load()) {
                             Midi_processor_manager::instance().clear_all_processors();
                         }
+                        Midi_processor_chain_monitor::instance().changed();
                         // Now ready to start running
                         state = Operating;
                         rppicomidi::Pico_pico_midi_lib::instance().write_cmd_to_tx_buffer(RESYNCHRONIZE, nullptr, 0);
@@ -461,84 +510,14 @@ void rppicomidi::Pico_mc_display_bridge_dev::request_dev_desc()
 
 void rppicomidi::Pico_mc_display_bridge_dev::midi_cb(uint8_t *rx, uint8_t buflen, uint8_t cable_num)
 {
+    uint8_t packet[4];
     for (uint8_t idx=0; idx<buflen; idx++) {
-        if (rx_packet[cable_num].idx == 0) {
-            // starting a new packet
-            uint8_t const msg = ((*rx) >> 4) & 0xF;
-            bool sysex_in_progress = (msg < MIDI_CIN_NOTE_OFF) && (rx_packet[cable_num].packet[0] & 0xF) == MIDI_CIN_SYSEX_START;
-            rx_packet[cable_num].packet[0] = cable_num << 4;
-            rx_packet[cable_num].packet[1] = *rx++;
-            rx_packet[cable_num].idx = 2;
-            if (msg >= MIDI_CIN_NOTE_OFF && msg <= MIDI_CIN_PITCH_BEND_CHANGE) {
-                // channel message
-                rx_packet[cable_num].packet[0] |= msg;
-                if (msg == MIDI_CIN_CHANNEL_PRESSURE || msg == MIDI_CIN_PROGRAM_CHANGE) {
-                    rx_packet[cable_num].size = 3;
-                    rx_packet[cable_num].packet[3] = 0;
-                }
-                else {
-                    rx_packet[cable_num].size = 4;
-                }
-            }
-            else if (rx_packet[cable_num].packet[1] == 0xF0 || sysex_in_progress) {
-                // cannot determine the proper size, but assume it needs at least 2 data bytes before EOX
-                // adjust if EOX comes sooner
-                rx_packet[cable_num].size = 4; 
-                rx_packet[cable_num].packet[0] |= MIDI_CIN_SYSEX_START;
-            }
-            else if (rx_packet[cable_num].packet[1] >= 0xF4) {
-                rx_packet[cable_num].packet[0] |= MIDI_CIN_SYSEX_END_1BYTE;
-                rx_packet[cable_num].size = 2;
-                rx_packet[cable_num].idx = 0; // we have the whole packet
-                rx_packet[cable_num].packet[2] = 0;
-                rx_packet[cable_num].packet[3] = 0;
-            }
-            else if (rx_packet[cable_num].packet[1] == 0xF1 || rx_packet[cable_num].packet[1] == 0xF3) {
-                rx_packet[cable_num].packet[0] |= MIDI_CIN_SYSCOM_2BYTE;
-                rx_packet[cable_num].size = 3; // 2 byte system message
-                rx_packet[cable_num].packet[3] = 0;
-            }
-            else if (rx_packet[cable_num].packet[1] == 0xF2) {
-                rx_packet[cable_num].packet[0] |= MIDI_CIN_SYSCOM_3BYTE;
-                rx_packet[cable_num].size = 4; // 3 byte system message
-            }
-            else {
-                // bad MIDI data stream
-                rx_packet[cable_num].idx = 0;
-                rx_packet[cable_num].size = 0;
-                printf("dropped MIDI stream byte idx=0 cable %u data 0x%02x\r\n", cable_num, rx_packet[cable_num].packet[1]);
-            }
-        }
-        else if (*rx == 0xF7) {
-            // EOX
-            uint8_t idx = rx_packet[cable_num].idx;
-            if (idx == 2) {
-                rx_packet[cable_num].packet[0] = (cable_num << 4) | MIDI_CIN_SYSEX_END_2BYTE;
-                rx_packet[cable_num].packet[3] = 0;
-                rx_packet[cable_num].size = 3;
-            }
-            else {
-                rx_packet[cable_num].packet[0] = (cable_num << 4) | MIDI_CIN_SYSEX_END_3BYTE;
-            }
-            rx_packet[cable_num].packet[idx] = *rx++;
-            rx_packet[cable_num].idx = 0; // we have the whole packet
-        }
-        else if (rx_packet[cable_num].idx < rx_packet[cable_num].size) {
-            // filling the packet
-            rx_packet[cable_num].packet[rx_packet[cable_num].idx++] = *rx++;
-            if (rx_packet[cable_num].idx == rx_packet[cable_num].size) {
-                rx_packet[cable_num].idx = 0;
-            }
-        }
-        else {
-            // packet overflow
-            printf("packet overflow\r\n");
-        }
-        if (rx_packet[cable_num].idx == 0 && rx_packet[cable_num].size != 0) {
+        if (rx_packetizer[cable_num].push(cable_num, rx[idx], packet)) {
             // received a whole packet; process it
-            if (Midi_processor_manager::instance().filter_midi_in(cable_num, rx_packet[cable_num].packet)) {
-                tud_midi_packet_write(rx_packet[cable_num].packet);
-                //tud_midi_stream_write(cable_num, rx_packet[cable_num].packet, 4);
+            Midi_processor_mc_display_core::instance().process_surface_packet(packet);
+            if ((instance().midi_in_bypass & (1u << cable_num)) ||
+                    Midi_processor_manager::instance().filter_midi_in(cable_num, packet)) {
+                tud_midi_packet_write(packet);
             }
         }
     }
@@ -546,7 +525,7 @@ void rppicomidi::Pico_mc_display_bridge_dev::midi_cb(uint8_t *rx, uint8_t buflen
 
 void rppicomidi::Pico_mc_display_bridge_dev::push_to_midi_uart(uint8_t* bytes, int nbytes, uint8_t cable_num)
 {
-    uint8_t npushed = Pico_pico_midi_lib::instance().write_midi_to_tx_buffer(bytes,nbytes,cable_num);
+    uint8_t npushed = Midi_uart_tx::instance().write(bytes,nbytes,cable_num);
     if (npushed != nbytes) {
         TU_LOG1("Warning: Dropped %d bytes sending to UART MIDI Out\r\n", nbytes - npushed);
     }
@@ -554,65 +533,25 @@ void rppicomidi::Pico_mc_display_bridge_dev::push_to_midi_uart(uint8_t* bytes, i
 
 void rppicomidi::Pico_mc_display_bridge_dev::push_to_midi_uart(uint8_t* packet, uint8_t cable_num)
 {
-    uint8_t nbytes = 1; // Real-time, tune request, reset, EOX and undefined system common
-    static bool in_sysex = false;
-    // ignore the cin bits because some products do not implement that correctly
-    if (packet[1] < 0xF0 && packet[1]>= 80) {
-        in_sysex = false;
-        uint8_t status = packet[1] & 0xF0;
-        if (status == 0xC0 || status == 0xD0) {
-            nbytes = 2;
-        }
-        else {
-            nbytes = 3;
-        }
-    }
-    else if (packet[1] == 0xF1 || packet[1] == 0xF3) {
-        // MTC Quarter Frame or Song Select
-        nbytes = 2;
-    }
-    else if (packet[1] == 0xF2) {
-        // Song Position Pointer
-        nbytes = 3;
-    }
-    else if (packet[1] == 0xF0) {
-        if (packet[2] == 0xF7) {
-            nbytes = 2;
-        }
-        else if (packet[3] == 0xF7) {
-            nbytes = 3;
-        }
-        else {
-            nbytes = 3;
-            in_sysex = true;
-        }
+    uint8_t nbytes = Midi_codec::depacketize(packet, uart_in_sysex[cable_num]);
+    if (nbytes == 0) {
+        TU_LOG1("Warning: Dropped packet %02x %02x %02x %02x sending to UART MIDI Out\r\n", packet[0], packet[1], packet[2], packet[3]);
+        return; // packet is poorly formed. Drop it
     }
-    else if (packet[1] == 0xF7) {
-        in_sysex = false;
+#if MIDI_OUT_DEDUP
+    // Only MC units use repeated note on and CC values for state; other cables pass everything
+    if (nbytes == 3 && Midi_processor_mc_display_core::instance().has_unit(cable_num) &&
+            midi_out_dedup.is_redundant(cable_num, packet+1)) {
+        return; // the surface already has this state
     }
-    else if (packet[1] < 0x80) {
-        if (in_sysex) {
-            // look for EOX
-            if (packet[2] == 0xF7) {
-                in_sysex = false;
-                nbytes = 2;
-            }
-            else if (packet[3] == 0xF7) {
-                in_sysex = false;
-                nbytes = 3;
-            }
-            else {
-                nbytes = 3;
-            }
-        }
-        else {
-            TU_LOG1("Warning: Dropped packet %02x %02x %02x %02x sending to UART MIDI Out\r\n", packet[0], packet[1], packet[2], packet[3]);
-            return; // packet is poorly formed. Drop it
-        }
-    }
-    uint8_t npushed = Pico_pico_midi_lib::instance().write_midi_to_tx_buffer(packet+1,nbytes,cable_num);
+#endif
+    uint8_t npushed = Midi_uart_tx::instance().write(packet+1,nbytes,cable_num);
     if (npushed != nbytes) {
         TU_LOG1("Warning: Dropped %d bytes sending to UART MIDI Out\r\n", nbytes - npushed);
+#if MIDI_OUT_DEDUP
+        // the dropped message may have been remembered as sent
+        midi_out_dedup.invalidate();
+#endif
     }
 }
 
@@ -626,42 +565,111 @@ void rppicomidi::Pico_mc_display_bridge_dev::poll_usb_rx(bool connected)
     if (!connected || !tud_midi_available()) {
         return;
     }
-    uint8_t rx[4];
-
-    while(tud_midi_n_packet_read(0, rx)) {
-        uint8_t const cable_num = (rx[0] >> 4) & 0xf;
-        if (!Midi_processor_manager::instance().filter_midi_out(cable_num, rx)) {
-            continue; // packet filtered out.
+    uint8_t rx[usb_rx_batch_size][4];
+    size_t npackets;
+    do {
+        // read everything available, up to one batch, in one pass
+        for (npackets = 0; npackets < usb_rx_batch_size && tud_midi_n_packet_read(0, rx[npackets]); npackets++) {
         }
-        // packet is not filtered out. Send it across to the Host Pico
-        push_to_midi_uart(rx, cable_num);
-    } // end processing one USB MIDI packet
+        // Send the packets that are not filtered out across to the Host Pico
+        for (size_t idx = 0; idx < npackets; idx++) {
+            uint8_t const cable_num = (rx[idx][0] >> 4) & 0xf;
+            if ((midi_out_bypass & (1u << cable_num)) || Midi_processor_manager::instance().filter_midi_out(cable_num, rx[idx])) {
+                push_to_midi_uart(rx[idx], cable_num);
+            }
+        }
+    } while (npackets == usb_rx_batch_size);
 }
 
-
 void rppicomidi::Pico_mc_display_bridge_dev::task()
 {
     bool connected = tud_midi_mounted();
     // poll MIDI receive from UART and USB
+    if (Midi_processor_chain_monitor::instance().take_changed())
+        update_bypass_bitmaps();
+#if MIDI_OUT_DEDUP
+    midi_out_dedup.task();
+#endif
     poll_midi_uart_rx(connected);
+    // send held back fader and VPot messages from the surface to the DAW
+    if (connected)
+        Midi_processor_flood_thin_core::instance().task();
     poll_usb_rx(connected);
     // Drain any transmissions that result
     Pico_pico_midi_lib::instance().drain_tx_buffer();
 
-    // Update the screens if need be
+    // Update the screens if need be. Messages since the last render only
+    // changed the channel strip state; draw each changed component once.
+    // Do not send the screen buffer to the display if nothing changed.
+    // A screen with any damage still sends its whole buffer; the Ssd1306
+    // driver has no call that sends only a page/column window.
     for (int chan = 0; chan < num_chan_displays; chan++) {
         channel_disp[chan]->task();
         if (screen[chan]->can_render()) {
-            screen[chan]->render_non_blocking(nullptr, chan);
+            channel_disp[chan]->draw_changes();
+            if (consume_damage(chan))
+                screen[chan]->render_non_blocking(nullptr, chan);
+            else
+                ++nrenders_skipped;
         }
         screen[chan]->task();
     }
+    log_draw_statistics();
 
     if (screen_tc.can_render()) {
+        Midi_processor_mc_display_core::instance().task();
+        seven_seg.draw_changes();
         screen_tc.render_non_blocking(nullptr, 0);
     }
     screen_tc.task();
 }
+void rppicomidi::Pico_mc_display_bridge_dev::update_bypass_bitmaps()
+{
+    uint16_t in_bypass = 0;
+    uint16_t out_bypass = 0;
+    for (uint8_t cable = 0; cable < 16; cable++) {
+        if (Midi_processor_manager::instance().get_num_midi_processors(cable, true) == 0)
+            in_bypass |= (1u << cable);
+        if (Midi_processor_manager::instance().get_num_midi_processors(cable, false) == 0)
+            out_bypass |= (1u << cable);
+    }
+    midi_in_bypass = in_bypass;
+    midi_out_bypass = out_bypass;
+}
+
+void rppicomidi::Pico_mc_display_bridge_dev::log_draw_statistics()
+{
+    static absolute_time_t previous_timestamp = {0};
+    absolute_time_t now = get_absolute_time();
+    if (absolute_time_diff_us(previous_timestamp, now) > 10000000) {
+        uint32_t ndraws_avoided = 0;
+        for (int chan = 0; chan < num_chan_displays; chan++) {
+            ndraws_avoided += channel_disp[chan]->get_draws_avoided();
+        }
+        TU_LOG2("%lu channel strip draws avoided\r\n", ndraws_avoided);
+#if MIDI_OUT_DEDUP
+        TU_LOG2("%lu redundant MIDI bytes not sent to the surface\r\n", midi_out_dedup.get_suppressed_bytes());
+#endif
+        TU_LOG2("%lu of %lu rendered channel strip pixels changed\r\n", ndamaged_pixels, nrendered_pixels);
+        TU_LOG2("%lu channel strip renders skipped\r\n", nrenders_skipped);
+        previous_timestamp = now;
+    }
+}
+
+bool rppicomidi::Pico_mc_display_bridge_dev::consume_damage(uint8_t chan)
+{
+    uint8_t num_areas;
+    const Mc_rect* areas = channel_disp[chan]->get_damage(num_areas);
+    if (num_areas == 0)
+        return false;
+    for (uint8_t idx = 0; idx < num_areas; idx++) {
+        ndamaged_pixels += areas[idx].width * areas[idx].height;
+    }
+    nrendered_pixels += screen[chan]->get_screen_width() * screen[chan]->get_screen_height();
+    channel_disp[chan]->clear_damage();
+    return true;
+}
+
 void rppicomidi::Pico_mc_display_bridge_dev::poll_midi_uart_rx(bool connected)
 {
     if (connected) {
@@ -792,3 +800,21 @@ void rppicomidi::Pico_mc_display_bridge_dev::static_handle_set_mc_cable(uint8_t
 {
     Pico_pico_midi_lib::instance().write_cmd_to_tx_buffer(RETURN_MC_CABLE, &cable_, 1);
 }
+
+bool rppicomidi::Pico_mc_display_bridge_dev::static_send_held_midi_in(uint8_t* packet, Midi_processor* proc, void*)
+{
+    uint8_t const cable_num = (packet[0] >> 4) & 0xf;
+    Midi_processor_manager& manager = Midi_processor_manager::instance();
+    size_t nprocs = manager.get_num_midi_processors(cable_num, true);
+    size_t idx = 0;
+    while (idx < nprocs && manager.get_midi_processor_by_index(idx, cable_num, true) != proc) {
+        ++idx;
+    }
+    // the processors up to and including proc already saw the packet.
+    // If proc is no longer in the chain, send the packet as is.
+    for (++idx; idx < nprocs; idx++) {
+        if (!manager.get_midi_processor_by_index(idx, cable_num, true)->process(packet))
+            return true; // filtered out
+    }
+    return tud_midi_packet_write(packet);
+}
@@ -42,15 +42,18 @@ rppicomidi::Mc_channel_strip_display::Mc_channel_strip_display(Mono_graphics& sc
     channel_text{screen,4,94,channel,screen.get_font_16()},
     meter{screen, 56, 0, channel_},
     vpot_display{screen, 0, 52, Vpot_mode::BOOST_CUT, 0, false},
+    fader{screen, 30, 0, 24, 48, &screen.get_font_8()},
     rec{screen, 0, 0 ,28, 12, "Rec", screen.get_font_8(), false},
     mute{screen, 0, 12 ,28, 12, "Mute", screen.get_font_8(), false},
     solo{screen, 0, 24 ,28, 12, "Solo", screen.get_font_8(), false},
-    sel{screen, 0, 36 ,28, 12, "Sel", screen.get_font_8(), false}
+    sel{screen, 0, 36 ,28, 12, "Sel", screen.get_font_8(), false},
+    button_leds{0}, drawn_button_leds{0}, nbutton_draws_avoided{0}, num_damage{0}
 {
     assert(screen.get_screen_height()==128 && screen.get_screen_width()==64);
     disp_objects.push_back(&channel_text);
     disp_objects.push_back(&meter);
     disp_objects.push_back(&vpot_display);
+    disp_objects.push_back(&fader);
     disp_objects.push_back(&rec);
     disp_objects.push_back(&mute);
     disp_objects.push_back(&solo);
@@ -60,68 +63,106 @@ rppicomidi::Mc_channel_strip_display::Mc_channel_strip_display(Mono_graphics& sc
 
 void rppicomidi::Mc_channel_strip_display::draw()
 {
+    draw_button_led_changes();
     screen.clear_canvas();
     for (auto& it : disp_objects) {
         it->draw();
-    }    
+    }
+    // The whole screen changed; forget the component areas
+    Mc_rect area;
+    channel_text.take_damage(area);
+    meter.take_damage(area);
+    vpot_display.take_damage(area);
+    fader.take_damage(area);
+    num_damage = 0;
+    add_damage({0, 0, screen.get_screen_width(), screen.get_screen_height()});
+}
+
+void rppicomidi::Mc_channel_strip_display::add_damage(const Mc_rect& area)
+{
+    if (num_damage < max_damage)
+        damage[num_damage++] = area;
+    else
+        damage[max_damage-1].add(area);
+}
+
+void rppicomidi::Mc_channel_strip_display::take_damage(Mc_drawable& component)
+{
+    Mc_rect area;
+    if (component.take_damage(area))
+        add_damage(area);
+}
+
+void rppicomidi::Mc_channel_strip_display::set_button_led(uint8_t led, bool is_on)
+{
+    if ((button_leds ^ drawn_button_leds) & led) {
+        // already waiting to draw this LED
+        ++nbutton_draws_avoided;
+    }
+    if (is_on)
+        button_leds |= led;
+    else
+        button_leds &= ~led;
 }
 
-bool rppicomidi::Mc_channel_strip_display::push_midi_message(uint8_t* message, int nbytes)
+void rppicomidi::Mc_channel_strip_display::draw_changes()
 {
-    bool success = true;
-    switch (message[0]) {
-        case 0x90:
-            // note message
-            if (message[1] == channel) {
-                // rec status
-                rec.set_state(message[2] != 0);
-            }
-            else if (message[1] == channel + 0x8) {
-                // solo status
-                solo.set_state(message[2] != 0);
-            }
-            else if (message[1] == channel + 0x10) {
-                // mute status
-                mute.set_state(message[2] != 0);
-            }
-            else if (message[1] == channel +0x18) {
-                // select status
-                sel.set_state(message[2] != 0);
-            }
-            else {
-                success = false;
-            }
-            break;
-        case 0xB0:
-            // CC message. Might be VPot status
-            if ((message[1] & 0xf0) == 0x30 && (message[1] & 0xf) == channel) {
-                vpot_display.set_by_cc_value(message[2]);
-            }
-            else {
-                success = false;
-            }
-            break;
-        case 0xD0:
-            if (((message[1] >>4 )&0x7) == channel) {
-                meter.set_value_by_channel_pressure(message[1]);
-            }
-            else {
-                success = false;
-            }
-            break;
-        case 0xF0:
-            // Might be set channel text message. Must start with F0 00 00 66 14|15 12 oo and end with F7 so
-            // must be greater than 8 bytes long or else it contains no character data and will have no effect
-            if (nbytes>8 && message[1]==0x00 && message[2]==0x00 && message[3]==0x66 && (message[4]==0x14 || message[4]==0x15) && message[5]==0x12 &&
-                message[nbytes-1] == 0xf7) {
-                success = channel_text.set_text_by_mc_sysex(message+6, nbytes - 8);
-            }
-            break;
-        default:
-            success = false;
-            break;
+    if (channel_text.draw_if_dirty())
+        take_damage(channel_text);
+    if (meter.draw_if_dirty())
+        take_damage(meter);
+    if (vpot_display.draw_if_dirty())
+        take_damage(vpot_display);
+    if (fader.draw_if_dirty())
+        take_damage(fader);
+    draw_button_led_changes();
+}
+
+void rppicomidi::Mc_channel_strip_display::draw_button_led_changes()
+{
+    uint8_t changed = button_leds ^ drawn_button_leds;
+    if (changed) {
+        // The Text_box areas match the constructor arguments
+        if (changed & rec_led) {
+            rec.set_state((button_leds & rec_led) != 0);
+            add_damage({0, 0, 28, 12});
+        }
+        if (changed & solo_led) {
+            solo.set_state((button_leds & solo_led) != 0);
+            add_damage({0, 24, 28, 12});
+        }
+        if (changed & mute_led) {
+            mute.set_state((button_leds & mute_led) != 0);
+            add_damage({0, 12, 28, 12});
+        }
+        if (changed & sel_led) {
+            sel.set_state((button_leds & sel_led) != 0);
+            add_damage({0, 36, 28, 12});
+        }
+        drawn_button_leds = button_leds;
     }
-    return success;
+}
+
+void rppicomidi::Mc_channel_strip_display::set_scribble_color(uint8_t color)
+{
+    using Style = Mc_channel_text::Style;
+    static constexpr Style color_styles[8] = {
+        Style::Plain,           // black (backlight off)
+        Style::Inverse,         // red
+        Style::Underline,       // green
+        Style::Inverse_top,     // yellow
+        Style::Top_and_underline, // blue
+        Style::Inverse_bottom,  // magenta
+        Style::Box,             // cyan
+        Style::Top_line,        // white
+    };
+    channel_text.set_style(color_styles[color & 0x7]);
+}
+
+uint32_t rppicomidi::Mc_channel_strip_display::get_draws_avoided() const
+{
+    return channel_text.get_draws_avoided() + meter.get_draws_avoided() + vpot_display.get_draws_avoided() +
+        fader.get_draws_avoided() + nbutton_draws_avoided;
 }
 
 void rppicomidi::Mc_channel_strip_display::task()
@@ -36,6 +36,7 @@
 #include "mc_channel_strip_display.h"
 #include "mc_channel_text.h"
 #include "mc_meter.h"
+#include "mc_fader.h"
 #include "mc_vpot_display.h"
 #include "text_box.h"
 #include <vector>
@@ -48,6 +49,37 @@ public:
 
     void draw();
 
+    /**
+     * @brief draw the screen components whose state changed since
+     * they were last drawn
+     *
+     * @note call this once per render cycle, just before rendering
+     * the screen buffer to the display
+     */
+    void draw_changes();
+
+    /**
+     * @brief Get the number of state changes that did not cause a
+     * redraw because they arrived before the previous change was drawn
+     */
+    uint32_t get_draws_avoided() const;
+
+    /**
+     * @brief Get the screen areas drawn since the last clear_damage()
+     *
+     * The render stage reads this list after draw_changes() to find
+     * the parts of the screen buffer that differ from the display.
+     * @param num_areas is set to the number of areas in the list
+     * @return the list of areas
+     */
+    const Mc_rect* get_damage(uint8_t& num_areas) const { num_areas = num_damage; return damage; }
+
+    /**
+     * @brief empty the damage list; call after the render stage has
+     * consumed it
+     */
+    void clear_damage() { num_damage = 0; }
+
     /**
      * @brief run any tasks of the screen components and process any complete
      * messages in the midi stream ring buffer.
@@ -55,16 +87,86 @@ public:
     void task();
 
     /**
-     * @brief send a MIDI message for possible processing
-     * 
-     * @param stream a pointer to the bytes to add
-     * @param nbytes the number of bytes to add
-     * @return true if message is consumed, false otherwise
+     * @brief Set one character of the channel strip text
+     *
+     * @param page the text page 0 or 1 (see Mc_channel_text::show_page())
+     * @param line the LCD line 0 or 1
+     * @param idx the character position 0-6 within the line
+     * @param ch the Mackie Control LCD character code
+     */
+    void set_text_char(uint8_t page, uint8_t line, uint8_t idx, uint8_t ch) { channel_text.set_char(page, line, idx, ch); }
+
+    /**
+     * @brief Choose which of the two channel text pages to display
+     *
+     * @param page the text page 0 or 1
      */
-    bool push_midi_message(uint8_t* message, int nbytes);
+    void show_text_page(uint8_t page) { channel_text.show_page(page); }
+
+    /**
+     * @brief Show an X-Touch scribble strip color as a channel text style
+     *
+     * @param color the color code 0-7 from the X-Touch scribble strip color message
+     */
+    void set_scribble_color(uint8_t color);
+
+    void set_rec(bool is_on) { set_button_led(rec_led, is_on); }
+    void set_solo(bool is_on) { set_button_led(solo_led, is_on); }
+    void set_mute(bool is_on) { set_button_led(mute_led, is_on); }
+    void set_sel(bool is_on) { set_button_led(sel_led, is_on); }
+
+    /**
+     * @brief Set the VPot LED ring from a Mackie Control VPot LED CC value
+     *
+     * @param cc_value the CC value (see Mc_vpot_display::set_by_cc_value())
+     */
+    void set_vpot_by_cc_value(uint8_t cc_value) { vpot_display.set_by_cc_value(cc_value); }
+
+    /**
+     * @brief Set the meter from a Mackie Control channel pressure data byte
+     *
+     * @param message the channel pressure data byte (see Mc_meter::set_value_by_channel_pressure())
+     */
+    void set_meter_by_channel_pressure(uint8_t message) { meter.set_value_by_channel_pressure(message); }
+
+    /**
+     * @brief Set the meter mode (see Mc_meter::set_mode())
+     *
+     * @param mode the mode byte of a Mackie Control channel meter mode message
+     */
+    void set_meter_mode(uint8_t mode) { meter.set_mode(mode); }
+
+    /**
+     * @brief Set the fader position from the data bytes of a Mackie Control pitch bend message
+     *
+     * @param lsb the least significant 7 bits of the position
+     * @param msb the most significant 7 bits of the position
+     */
+    void set_fader_by_pitch_bend(uint8_t lsb, uint8_t msb) { fader.set_position_by_pitch_bend(lsb, msb); }
 private:
     Mc_channel_strip_display() = delete;
     Mc_channel_strip_display(Mc_channel_strip_display&) = delete;
+    static const uint8_t rec_led = 0x1;
+    static const uint8_t solo_led = 0x2;
+    static const uint8_t mute_led = 0x4;
+    static const uint8_t sel_led = 0x8;
+    /**
+     * @brief set the requested state of a button LED; the Text_box
+     * is updated by draw_changes()
+     */
+    void set_button_led(uint8_t led, bool is_on);
+    void draw_button_led_changes();
+
+    /**
+     * @brief add an area to the damage list. If the list is full, the
+     * area is merged with the last area in the list.
+     */
+    void add_damage(const Mc_rect& area);
+
+    /**
+     * @brief move the damage a component reported to the damage list
+     */
+    void take_damage(Mc_drawable& component);
 
     Mono_graphics& screen;
     uint8_t channel;
@@ -72,10 +174,17 @@ private:
     Mc_channel_text channel_text;
     Mc_meter meter;
     Mc_vpot_display vpot_display;
+    Mc_fader fader;
     Text_box rec;
     Text_box mute;
     Text_box solo;
     Text_box sel;
+    uint8_t button_leds;        // requested button LED states
+    uint8_t drawn_button_leds;  // button LED states last drawn
+    uint32_t nbutton_draws_avoided;
     std::vector<Drawable*> disp_objects;
+    static const uint8_t max_damage = 8;
+    Mc_rect damage[max_damage]; // the areas drawn since the last clear_damage()
+    uint8_t num_damage;
 };
 }
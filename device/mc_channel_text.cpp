@@ -33,20 +33,86 @@
 #include "mc_channel_text.h"
 #include "pico/assert.h"
 rppicomidi::Mc_channel_text::Mc_channel_text(Mono_graphics& screen_, uint8_t x_, uint8_t y_, uint8_t channel_, const Mono_mono_font& font_) :
-    screen{screen_}, x{x_}, y{y_}, channel{channel_}, font{font_}
+    screen{screen_}, x{x_}, y{y_}, channel{channel_}, font{font_}, page{0}, style{Style::Top_line}, drawn_style{Style::Top_line}
 {
-    // pad with ' '  1234567
-    strcpy(text[0], "       ");
-    strcpy(text[1], "Ch     ");
-    text[1][3] = channel+'1';
+    for (uint8_t pg = 0; pg < num_pages; pg++) {
+        // pad with ' '      1234567
+        strcpy(text[pg][0], "       ");
+        strcpy(text[pg][1], "Ch     ");
+        text[pg][1][3] = channel+'1';
+    }
     draw();
 }
 
 void rppicomidi::Mc_channel_text::draw()
 {
-    screen.draw_line(0, y, screen.get_screen_width()-1, y, Pixel_state::PIXEL_ONE, true);
+    memcpy(drawn_text, text[page], sizeof(drawn_text));
+    drawn_style = style;
+    uint8_t width = screen.get_screen_width();
+    uint8_t height = 2 + 2*font.height;
+    add_damage(0, y, width, height);
+    // erase the previous decoration
+    screen.draw_rectangle(0, y, width, height, Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
     for (int idx = 0; idx < 2; idx++) {
-        screen.draw_string(font, x, 2+y + idx* font.height, text[idx], 7, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+        bool inverse = style == Style::Inverse || (style == Style::Inverse_top && idx == 0) ||
+            (style == Style::Inverse_bottom && idx == 1);
+        Pixel_state fg = inverse ? Pixel_state::PIXEL_ZERO : Pixel_state::PIXEL_ONE;
+        Pixel_state bg = inverse ? Pixel_state::PIXEL_ONE : Pixel_state::PIXEL_ZERO;
+        uint8_t text_y = 2+y + idx* font.height;
+        if (inverse) {
+            screen.draw_rectangle(0, text_y, width, font.height, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE);
+        }
+        screen.draw_string(font, x, text_y, text[page][idx], 7, fg, bg);
+    }
+    switch (style) {
+        case Style::Top_line:
+            screen.draw_line(0, y, width-1, y, Pixel_state::PIXEL_ONE, true);
+            break;
+        case Style::Underline:
+            screen.draw_line(0, y+height-1, width-1, y+height-1, Pixel_state::PIXEL_ONE, true);
+            break;
+        case Style::Box:
+            screen.draw_rectangle(0, y, width, height, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_TRANSPARENT);
+            break;
+        case Style::Top_and_underline:
+            screen.draw_line(0, y, width-1, y, Pixel_state::PIXEL_ONE, true);
+            screen.draw_line(0, y+height-1, width-1, y+height-1, Pixel_state::PIXEL_ONE, true);
+            break;
+        default:
+            break;
+    }
+}
+
+void rppicomidi::Mc_channel_text::draw_dirty()
+{
+    if (style != drawn_style) {
+        draw();
+        return;
+    }
+    // Every character drawn on a rotated screen is plotted a pixel at a time,
+    // so skip the characters that did not change
+    for (int idx = 0; idx < 2; idx++) {
+        bool inverse = style == Style::Inverse || (style == Style::Inverse_top && idx == 0) ||
+            (style == Style::Inverse_bottom && idx == 1);
+        Pixel_state fg = inverse ? Pixel_state::PIXEL_ZERO : Pixel_state::PIXEL_ONE;
+        Pixel_state bg = inverse ? Pixel_state::PIXEL_ONE : Pixel_state::PIXEL_ZERO;
+        uint8_t text_y = 2+y + idx* font.height;
+        for (int ch_idx = 0; ch_idx < 7; ch_idx++) {
+            char ch = text[page][idx][ch_idx];
+            if (ch != drawn_text[idx][ch_idx]) {
+                add_damage(x + ch_idx*font.width, text_y, font.width, font.height);
+                screen.draw_character(font, x + ch_idx*font.width, text_y, ch, fg, bg);
+                drawn_text[idx][ch_idx] = ch;
+            }
+        }
+    }
+}
+
+void rppicomidi::Mc_channel_text::set_style(Style style_)
+{
+    if (style_ != style) {
+        style = style_;
+        mark_dirty();
     }
 }
 
@@ -55,39 +121,30 @@ void rppicomidi::Mc_channel_text::set_text(uint8_t line, uint8_t offset, const c
     assert(line < 2);
     assert(offset < 7);
     // non-destructive (don't add null termination) strncpy
-    for (int idx=offset; idx < 7 && text_[idx] != '\0'; idx++) {
-        // If the character is not in the font character set, display
-        // the first character in the font instead (usually space)
-        char ch = text_[idx];
-        if (ch<font.first_char && ch>font.last_char)
-            ch = font.first_char;
-        text[line][idx] =  ch;
+    for (int idx=offset; idx < 7 && text_[idx-offset] != '\0'; idx++) {
+        text[page][line][idx] = to_glyph(text_[idx-offset]);
     }
-    draw();
+    mark_dirty();
 }
 
-bool rppicomidi::Mc_channel_text::set_text_by_mc_sysex(const uint8_t* sysex_message, uint8_t num_chars)
+void rppicomidi::Mc_channel_text::set_char(uint8_t page_, uint8_t line, uint8_t idx, uint8_t ch)
 {
-    assert(num_chars >= 1);
-    assert(sysex_message);
-    bool success = false;
-    uint8_t offset= sysex_message[0];
-    uint8_t line_offset = channel *7;
-    for (int line = 0; line < 2; line++) {
-        if ((line_offset+6) >= offset) {
-            // then there may be characters for this field
-            int field_offset = offset %7;
-            int char_offset = (line_offset > offset) ? 0: field_offset;
-            uint8_t message_char_idx = line_offset + char_offset - offset + 1;
-            for (int ch_idx = char_offset; ch_idx < 7 && message_char_idx <= num_chars; ch_idx++) {
-                text[line][ch_idx] = sysex_message[message_char_idx++];
-                success = true;
-            }
-        }
-        line_offset+=56;
-    }
-    if (success) {
-        draw();
+    assert(page_ < num_pages);
+    assert(line < 2);
+    assert(idx < 7);
+    char glyph = to_glyph(ch);
+    if (glyph == text[page_][line][idx])
+        return;
+    text[page_][line][idx] = glyph;
+    if (page_ == page)
+        mark_dirty();
+}
+
+void rppicomidi::Mc_channel_text::show_page(uint8_t page_)
+{
+    assert(page_ < num_pages);
+    if (page_ != page) {
+        page = page_;
+        mark_dirty();
     }
-    return success;
-}
\ No newline at end of file
+}
@@ -27,9 +27,26 @@
  */
 #pragma once
 #include "mono_graphics_lib.h"
-#include "drawable.h"
+#include "mc_drawable.h"
 namespace rppicomidi {
-class Mc_channel_text : public Drawable
+struct Mc_charset {
+    char ch[128];
+};
+/**
+ * @brief build the table of ASCII equivalents of the Mackie Control LCD
+ * character codes. The LCD displays codes 0x20-0x7E as ASCII; the rest
+ * display as space.
+ */
+constexpr Mc_charset make_mackie_charset() {
+    Mc_charset charset{};
+    for (int code = 0; code < 128; code++) {
+        charset.ch[code] = (code >= 0x20 && code < 0x7F) ? (char)code : ' ';
+    }
+    return charset;
+}
+inline constexpr Mc_charset mackie_charset = make_mackie_charset();
+
+class Mc_channel_text : public Mc_drawable
 {
 public:
     /**
@@ -61,28 +78,87 @@ public:
     void set_text(uint8_t line, uint8_t offset, const char* text_);
 
     /**
-     * @brief Extract the text for this channel from a Mackie Control 
-     * LCD system exclusive message
-     * 
+     * @brief Set one character of the text
+     *
      * The Mackie Control LCD assumes a single two line by 56 character
      * display. The LCD message format is
      * 0xF0 0x00 0x00 0x66 0x14 0x12 oo [up to 112 characters] 0xF7 where
      * oo is display line offset 0-55 for the first line and and 56-111
-     * for the second line.
-     * 
-     * @param sysex_message A pointer to the sysex message body starting at the oo byte
-     * @param num_chars the number of characters to write (excludes the oo byte)
+     * for the second line. Characters 7*channel through 7*channel+6 of
+     * each line belong to this channel.
+     *
+     * @param page the text page 0 or 1 (see show_page())
+     * @param line line number either 0 or 1
+     * @param idx the character position 0-6 within the line
+     * @param ch the character code from the LCD message. Codes with no glyph
+     * in the font display as the first character of the font (usually space).
+     */
+    void set_char(uint8_t page, uint8_t line, uint8_t idx, uint8_t ch);
+
+    /**
+     * @brief Choose which of the two text pages to display
+     *
+     * The DAW sends different LCD text when the NAME/VALUE button is
+     * toggled. Keeping both pages allows the display to switch before
+     * the DAW resends the text.
+     * @param page_ the text page 0 or 1
+     */
+    void show_page(uint8_t page_);
+
+    static const uint8_t num_pages = 2;
+
+    /**
+     * @brief The ways the text can be decorated to tell channel strips apart
+     */
+    enum class Style : uint8_t {
+        Top_line,       // a line above the text (the default)
+        Plain,          // no decoration
+        Underline,      // a line below the text
+        Inverse_top,    // the first line is drawn inverted
+        Inverse_bottom, // the second line is drawn inverted
+        Inverse,        // both lines are drawn inverted
+        Box,            // a box around the text
+        Top_and_underline, // a line above and a line below the text
+    };
+
+    /**
+     * @brief Set how the text is decorated
+     *
+     * @param style_ the new style
      */
-    bool set_text_by_mc_sysex(const uint8_t* sysex_message, uint8_t num_chars);
+    void set_style(Style style_);
+protected:
+    /**
+     * @brief draw only the characters that changed since the last draw;
+     * a style change redraws everything
+     *
+     * @note the characters that are drawn still go through the rotation
+     * transform of Mono_graphics::draw_character() a pixel at a time
+     */
+    void draw_dirty() final;
 private:
     // Get rid of default constructor and copy constructor
     Mc_channel_text() = delete;
     Mc_channel_text(Mc_channel_text&) = delete;
 
+    /**
+     * @brief get the font character to draw for a Mackie Control LCD
+     * character code. If the character is not in the font character set,
+     * the first character in the font (usually space) is drawn instead.
+     */
+    char to_glyph(uint8_t code) const {
+        char ch = mackie_charset.ch[code & 0x7F];
+        return (ch < font.first_char || ch > font.last_char) ? font.first_char : ch;
+    }
+
     Mono_graphics& screen;
     uint8_t x,y;
     uint8_t channel;
-    char text[2][8]; // An array of 2 7-character null-terminated strings always right padded with spaces
+    char text[num_pages][2][8]; // For each page, an array of 2 7-character null-terminated strings always right padded with spaces
     const Mono_mono_font& font;
+    uint8_t page; // the page to display
+    Style style;
+    char drawn_text[2][8]; // the text last drawn
+    Style drawn_style;     // the style last drawn
 };
 }
\ No newline at end of file
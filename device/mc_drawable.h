@@ -0,0 +1,128 @@
+/**
+ * @file mc_drawable.h
+ * @brief This class adds deferred drawing to a Drawable.
+ * Setters only update the object state and mark it dirty;
+ * the owner draws the dirty objects once per render cycle
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#pragma once
+#include <cstdint>
+#include "drawable.h"
+namespace rppicomidi {
+/**
+ * @brief A screen area in screen coordinates
+ */
+struct Mc_rect {
+    uint8_t x, y;
+    uint8_t width, height; // a width or height of 0 is an empty area
+
+    bool is_empty() const { return width == 0 || height == 0; }
+
+    /**
+     * @brief grow this area so it also covers another area
+     */
+    void add(const Mc_rect& other) {
+        if (other.is_empty())
+            return;
+        if (is_empty()) {
+            *this = other;
+            return;
+        }
+        uint8_t right = x + width > other.x + other.width ? x + width : other.x + other.width;
+        uint8_t bottom = y + height > other.y + other.height ? y + height : other.y + other.height;
+        x = x < other.x ? x : other.x;
+        y = y < other.y ? y : other.y;
+        width = right - x;
+        height = bottom - y;
+    }
+};
+
+class Mc_drawable : public Drawable
+{
+public:
+    Mc_drawable() : dirty{false}, ndraws_avoided{0}, damage{0, 0, 0, 0} {}
+    virtual ~Mc_drawable() = default;
+
+    /**
+     * @brief draw the object to the screen buffer if its state
+     * changed since the last time it was drawn
+     *
+     * @return true if the object was drawn
+     */
+    bool draw_if_dirty() {
+        if (!dirty)
+            return false;
+        dirty = false;
+        draw_dirty();
+        return true;
+    }
+
+    bool is_dirty() const { return dirty; }
+
+    /**
+     * @brief get the screen area that the object drew since the last
+     * call to this function and forget it
+     *
+     * @param area is set to the drawn area
+     * @return true if the object drew something
+     */
+    bool take_damage(Mc_rect& area) {
+        area = damage;
+        damage = {0, 0, 0, 0};
+        return !area.is_empty();
+    }
+
+    /**
+     * @brief Get the number of state changes that did not require
+     * a draw because the object was already waiting to be drawn
+     */
+    uint32_t get_draws_avoided() const { return ndraws_avoided; }
+protected:
+    /**
+     * @brief call this from every setter instead of draw()
+     */
+    void mark_dirty() {
+        if (dirty)
+            ++ndraws_avoided;
+        dirty = true;
+    }
+
+    /**
+     * @brief draw the state changes to the screen buffer. The default
+     * redraws the whole object; override it if the object can redraw
+     * only the parts that changed since the last draw()
+     */
+    virtual void draw_dirty() { draw(); }
+
+    /**
+     * @brief call this from draw() and draw_dirty() with each
+     * screen area that was drawn
+     */
+    void add_damage(uint8_t x, uint8_t y, uint8_t width, uint8_t height) { damage.add({x, y, width, height}); }
+private:
+    bool dirty;
+    uint32_t ndraws_avoided;
+    Mc_rect damage; // the bounding box of the areas drawn since the last take_damage()
+};
+}
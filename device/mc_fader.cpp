@@ -0,0 +1,127 @@
+/**
+ * @file mc_fader.cpp
+ * @brief This class implements drawing the position of a Mackie Control
+ * motor fader as set by the DAW's pitch bend messages
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#include <cstdio>
+#include <cstring>
+#include "mc_fader.h"
+
+rppicomidi::Mc_fader::Mc_fader(Mono_graphics& screen_, uint8_t x_, uint8_t y_, uint8_t width_, uint8_t height_, const Mono_mono_font* db_font_) :
+    screen{screen_}, x{x_}, y{y_}, width{width_}, height{height_}, db_font{db_font_},
+    vertical{height_ > width_}, position{0}
+{
+}
+
+void rppicomidi::Mc_fader::set_position(uint16_t position_)
+{
+    if (position_ > max_position)
+        position_ = max_position;
+    if (position_ != position) {
+        position = position_;
+        mark_dirty();
+    }
+}
+
+int16_t rppicomidi::Mc_fader::position_to_db_tenths(uint16_t position_)
+{
+    // fader position, level in tenths of a dB; sorted by position
+    static const struct {
+        uint16_t position;
+        int16_t db_tenths;
+    } db_table[] = {
+        {0, -900},
+        {1024, -600},
+        {2048, -400},
+        {4096, -300},
+        {6144, -200},
+        {8192, -100},
+        {10240, -50},
+        {12288, 0},
+        {max_position, 60},
+    };
+    if (position_ == 0)
+        return min_db_tenths;
+    if (position_ >= max_position)
+        return db_table[sizeof(db_table)/sizeof(db_table[0])-1].db_tenths;
+    size_t idx = 1;
+    while (db_table[idx].position < position_)
+        ++idx;
+    // linear interpolation between table entries idx-1 and idx
+    int32_t dpos = db_table[idx].position - db_table[idx-1].position;
+    int32_t ddb = db_table[idx].db_tenths - db_table[idx-1].db_tenths;
+    return db_table[idx-1].db_tenths + ((int32_t)(position_ - db_table[idx-1].position) * ddb) / dpos;
+}
+
+void rppicomidi::Mc_fader::format_db(char* text, size_t maxlen)
+{
+    int16_t db_tenths = position_to_db_tenths(position);
+    if (db_tenths == min_db_tenths) {
+        snprintf(text, maxlen, "-inf");
+    }
+    else if (db_tenths <= -100) {
+        snprintf(text, maxlen, "%d", db_tenths/10);
+    }
+    else {
+        int abs_tenths = db_tenths < 0 ? -db_tenths : db_tenths;
+        snprintf(text, maxlen, "%c%d.%d", db_tenths < 0 ? '-':'+', abs_tenths/10, abs_tenths%10);
+    }
+}
+
+void rppicomidi::Mc_fader::draw()
+{
+    uint8_t track_height = height;
+    if (db_font) {
+        track_height -= db_font->height;
+    }
+    add_damage(x, y, width, height);
+    // clear the old cap and draw the track
+    screen.draw_rectangle(x, y, width, track_height, Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
+    if (vertical) {
+        uint8_t track_x = x + width/2 - 1;
+        screen.draw_rectangle(track_x, y, 2, track_height, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE);
+        uint8_t travel = track_height - cap_size;
+        uint8_t cap_y = y + travel - (uint8_t)(((uint32_t)position * travel) / max_position);
+        screen.draw_rectangle(x, cap_y, width, cap_size, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE);
+    }
+    else {
+        uint8_t track_y = y + track_height/2 - 1;
+        screen.draw_rectangle(x, track_y, width, 2, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE);
+        uint8_t travel = width - cap_size;
+        uint8_t cap_x = x + (uint8_t)(((uint32_t)position * travel) / max_position);
+        screen.draw_rectangle(cap_x, y, cap_size, track_height, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE);
+    }
+    if (db_font) {
+        char text[8];
+        format_db(text, sizeof(text));
+        size_t len = strlen(text);
+        uint8_t text_y = y + track_height;
+        screen.draw_rectangle(x, text_y, width, db_font->height, Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
+        int text_x = x + width/2 - (len*db_font->width)/2;
+        if (text_x < x)
+            text_x = x;
+        screen.draw_string(*db_font, text_x, text_y, text, len, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * @file mc_fader.h
+ * @brief This class implements drawing the position of a Mackie Control
+ * motor fader as set by the DAW's pitch bend messages
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#pragma once
+#include "mono_graphics_lib.h"
+#include "mc_drawable.h"
+namespace rppicomidi {
+class Mc_fader : public Mc_drawable
+{
+public:
+    /**
+     * @brief Construct a new Mc_fader object
+     *
+     * The fader is vertical if height_ is greater than width_; otherwise it is horizontal.
+     * @param screen_ the screen to draw on
+     * @param x_ the left edge of the fader area
+     * @param y_ the top edge of the fader area
+     * @param width_ the width of the fader area
+     * @param height_ the height of the fader area including the dB readout
+     * @param db_font_ if not nullptr, the fader level in dB is drawn in this font
+     * below the fader track
+     */
+    Mc_fader(Mono_graphics& screen_, uint8_t x_, uint8_t y_, uint8_t width_, uint8_t height_, const Mono_mono_font* db_font_);
+
+    virtual ~Mc_fader() = default;
+
+    /**
+     * @brief Set the fader position
+     *
+     * @param position_ the 14-bit fader position 0-16383
+     */
+    void set_position(uint16_t position_);
+
+    /**
+     * @brief Set the fader position from the data bytes of a Mackie Control
+     * pitch bend message
+     *
+     * @param lsb the least significant 7 bits of the position
+     * @param msb the most significant 7 bits of the position
+     */
+    void set_position_by_pitch_bend(uint8_t lsb, uint8_t msb) { set_position(((uint16_t)(msb & 0x7f) << 7) | (lsb & 0x7f)); }
+
+    uint16_t get_position() const { return position; }
+
+    /**
+     * @brief convert a fader position to a level in tenths of a dB
+     *
+     * The DAW's fader law is not part of the Mackie Control protocol; this uses
+     * a piecewise linear approximation of a typical +6 dB to -inf scale
+     * @param position_ the 14-bit fader position 0-16383
+     * @return the level in tenths of a dB or min_db_tenths for -inf
+     */
+    static int16_t position_to_db_tenths(uint16_t position_);
+
+    static const int16_t min_db_tenths = INT16_MIN;
+
+    /**
+     * @brief draw the fader to the screen buffer
+     */
+    void draw() final;
+private:
+    Mc_fader() = delete;
+    Mc_fader(Mc_fader&) = delete;
+    /**
+     * @brief format the fader level in at most 4 characters plus the terminator
+     */
+    void format_db(char* text, size_t maxlen);
+
+    static const uint16_t max_position = 16383;
+    static const uint8_t cap_size = 4; // fader cap thickness in pixels
+    Mono_graphics& screen;
+    uint8_t x, y;
+    uint8_t width, height;
+    const Mono_mono_font* db_font;
+    bool vertical;
+    uint16_t position;
+};
+}
@@ -0,0 +1,100 @@
+/**
+ * @file mc_lcd_model.cpp
+ * @brief This class keeps a shadow copy of the Mackie Control
+ * 2 line by 56 character LCD
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#include <cstring>
+#include "mc_lcd_model.h"
+
+rppicomidi::Mc_lcd_model::Mc_lcd_model() :
+    page{0}, toggle_pending{false}, message_page{0}, message_confirms_toggle{false}, num_chan_displays{0}, channel_disp{nullptr}, nunchanged{0}
+{
+    // the channel strips show their own text until the first LCD message
+    memset(lcd, unknown_char, sizeof(lcd));
+    toggle_time = get_absolute_time();
+}
+
+void rppicomidi::Mc_lcd_model::begin_message()
+{
+    message_page = page;
+    message_confirms_toggle = toggle_pending;
+}
+
+bool rppicomidi::Mc_lcd_model::set_char(uint8_t pos, uint8_t ch)
+{
+    if (pos >= num_chars)
+        return false;
+    return write_char(message_page, pos, ch);
+}
+
+void rppicomidi::Mc_lcd_model::end_message()
+{
+    if (message_confirms_toggle && toggle_pending) {
+        // the DAW sent a whole LCD message in the new mode
+        toggle_pending = false;
+    }
+    message_confirms_toggle = false;
+}
+
+bool rppicomidi::Mc_lcd_model::write_char(uint8_t page_, uint8_t pos, uint8_t ch)
+{
+    if (lcd[page_][pos] == ch) {
+        ++nunchanged;
+        return false;
+    }
+    lcd[page_][pos] = ch;
+    uint8_t line = pos / line_length;
+    uint8_t column = pos % line_length;
+    uint8_t chan = column / cell_length;
+    if (chan < num_chan_displays) {
+        channel_disp[chan]->set_text_char(page_, line, column % cell_length, ch);
+    }
+    return true;
+}
+
+void rppicomidi::Mc_lcd_model::set_page(uint8_t page_)
+{
+    page = page_;
+    for (uint8_t chan = 0; chan < num_chan_displays; chan++) {
+        channel_disp[chan]->show_text_page(page);
+    }
+}
+
+void rppicomidi::Mc_lcd_model::toggle_page()
+{
+    set_page((page + 1) % num_pages);
+    // pressing the button again before the DAW responds toggles back
+    toggle_pending = !toggle_pending;
+    toggle_time = get_absolute_time();
+}
+
+void rppicomidi::Mc_lcd_model::task()
+{
+    if (toggle_pending && absolute_time_diff_us(toggle_time, get_absolute_time()) > toggle_timeout_ms*1000ll) {
+        // The DAW did not respond to the NAME/VALUE button. Show the page it is still writing
+        toggle_pending = false;
+        set_page((page + 1) % num_pages);
+    }
+}
@@ -0,0 +1,148 @@
+/**
+ * @file mc_lcd_model.h
+ * @brief This class keeps a shadow copy of the Mackie Control
+ * 2 line by 56 character LCD and forwards only the characters
+ * that change to the channel strip that displays them
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#pragma once
+#include <cstdint>
+#include "pico/time.h"
+#include "mc_channel_strip_display.h"
+namespace rppicomidi {
+class Mc_lcd_model
+{
+public:
+    Mc_lcd_model();
+
+    /**
+     * @brief attach the channel strips that show the LCD text
+     *
+     * @param num_chan_displays_ the number of channel strips; 7-character cell n
+     * of each LCD line is shown on channel strip n
+     * @param channel_disp_ an array of num_chan_displays_ channel strip pointers
+     */
+    void set_channel_strips(uint8_t num_chan_displays_, Mc_channel_strip_display **channel_disp_) {
+        num_chan_displays = num_chan_displays_;
+        channel_disp = channel_disp_;
+    }
+
+    /**
+     * @brief start an LCD text message
+     *
+     * The characters of the message go to the page the channel strips show
+     * now, even if the NAME/VALUE button is pressed before the message ends.
+     */
+    void begin_message();
+
+    /**
+     * @brief write one character of the current LCD text message
+     *
+     * If the character differs from the one already on the message's page,
+     * the channel strip that displays it is updated.
+     *
+     * @param pos the LCD position 0-111; 0-55 is the first line, 56-111 the second
+     * @param ch the Mackie Control LCD character code
+     * @return true if the character changed
+     */
+    bool set_char(uint8_t pos, uint8_t ch);
+
+    /**
+     * @brief finish the current LCD text message
+     *
+     * A whole message that started after the NAME/VALUE button press
+     * confirms the page toggle.
+     */
+    void end_message();
+
+    /**
+     * @brief get the characters of the page the channel strips show
+     *
+     * @return num_chars LCD character codes; unknown characters are 0xFF
+     */
+    const uint8_t* get_chars() const { return lcd[page]; }
+
+    /**
+     * @brief check if the channel strips show the NAME text
+     *
+     * MC DAWs start in NAME mode, so page 0 holds the track names and the
+     * NAME/VALUE button switches to page 1 for the values.
+     */
+    bool is_name_page() const { return page == name_page; }
+
+    /**
+     * @brief Get the number of characters written that matched the
+     * character already on the LCD
+     */
+    uint32_t get_unchanged_count() const { return nunchanged; }
+
+    /**
+     * @brief Switch the channel strips to the other LCD page
+     *
+     * Call when the NAME/VALUE button is pressed. The DAW normally responds
+     * by resending the whole LCD in the other mode; until it does, the
+     * channel strips show the text last received in that mode. The first
+     * complete LCD message that started after the press confirms the switch
+     * and is written to the new page; the rest of a message that was in
+     * flight at the press still goes to the old page. If no LCD message
+     * is confirmed within toggle_timeout_ms, the DAW ignored the button and
+     * the display switches back.
+     */
+    void toggle_page();
+
+    /**
+     * @brief revert an unconfirmed page toggle after the timeout
+     */
+    void task();
+
+    static const uint8_t line_length = 56;
+    static const uint8_t num_chars = line_length*2;
+    static const uint8_t cell_length = 7;
+    static const uint8_t num_pages = Mc_channel_text::num_pages;
+    static const uint8_t name_page = 0;
+private:
+    /**
+     * @brief make page the one the DAW writes and the channel strips show
+     */
+    void set_page(uint8_t page_);
+
+    /**
+     * @brief write a character to page_ and update the channel strip
+     * if it changed
+     */
+    bool write_char(uint8_t page_, uint8_t pos, uint8_t ch);
+
+    static const uint8_t unknown_char = 0xFF; // never matches a 7-bit character code
+    static const uint32_t toggle_timeout_ms = 500;
+    uint8_t lcd[num_pages][num_chars]; // one LCD shadow for the NAME text and one for the VALUE text
+    uint8_t page;               // the page the DAW writes and the channel strips show
+    bool toggle_pending;        // true if toggle_page() was called and no LCD message confirmed it since
+    uint8_t message_page;       // the page the current LCD text message writes
+    bool message_confirms_toggle; // true if the current LCD text message started while toggle_pending
+    absolute_time_t toggle_time;
+    uint8_t num_chan_displays;
+    Mc_channel_strip_display **channel_disp;
+    uint32_t nunchanged;
+};
+}
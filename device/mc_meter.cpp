@@ -30,33 +30,117 @@
 #include "pico/time.h"
 
 rppicomidi::Mc_meter::Mc_meter(Mono_graphics& screen_, uint8_t x_, uint8_t y_, uint8_t meter_channel_) :
-        screen{screen_}, x{x_}, y{y_}, meter_channel{meter_channel_}, value{0}, overload{false}
+        screen{screen_}, x{x_}, y{y_}, meter_channel{meter_channel_}, value{0}, peak{0}, overload{false},
+        mode{lcd_meter_mode}, drawn_segments{0}, drawn_mode{lcd_meter_mode}
 {
     time_last_value_set = get_absolute_time();
     draw();
 }
 
+namespace rppicomidi {
+static constexpr uint16_t meter_level_bits(uint8_t level)
+{
+    return static_cast<uint16_t>(((1u << level) - 1) << 1);
+}
+
+constexpr uint16_t Mc_meter::level_segments[13] = {
+    meter_level_bits(0), meter_level_bits(1), meter_level_bits(2), meter_level_bits(3), meter_level_bits(4),
+    meter_level_bits(5), meter_level_bits(6), meter_level_bits(7), meter_level_bits(8), meter_level_bits(9),
+    meter_level_bits(10), meter_level_bits(11), meter_level_bits(12),
+};
+}
+
+uint16_t rppicomidi::Mc_meter::get_segments() const
+{
+    uint16_t segments = overload ? overload_segment : 0;
+    if (mode & lcd_meter_mode) {
+        segments |= level_segments[value];
+        if ((mode & peak_hold_mode) && peak > 0)
+            segments |= 1u << peak;
+    }
+    if ((mode & signal_led_mode) && value > 0)
+        segments |= signal_led_segment;
+    return segments;
+}
+
+void rppicomidi::Mc_meter::draw_dirty()
+{
+    if (mode != drawn_mode) {
+        draw();
+        return;
+    }
+    uint16_t segments = get_segments();
+    uint16_t changed = segments ^ drawn_segments;
+    // The segment outlines do not change, so only fill or clear the inside
+    for (uint8_t segment = 0; segment <= 12; segment++) {
+        if (changed & (1u << segment)) {
+            Pixel_state fill = (segments & (1u << segment)) ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO;
+            add_damage(x+1, segment_y(segment)+1, 6, 6);
+            screen.draw_rectangle(x+1, segment_y(segment)+1, 6, 6, fill, fill);
+        }
+    }
+    if (changed & signal_led_segment) {
+        add_damage(x-5, y+7+11*7+2, 5, 5);
+        screen.draw_centered_circle(x-3, y+7+11*7+4, 2, Pixel_state::PIXEL_ONE,
+            (segments & signal_led_segment) ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO);
+    }
+    drawn_segments = segments;
+}
+
 void rppicomidi::Mc_meter::draw()
 {
-    screen.draw_rectangle(x,y, 8, 8, Pixel_state::PIXEL_ONE, overload ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO);
-    for (int idx = 0; idx < 12; idx++) {
-        Pixel_state fill = (value > (11-idx)) ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO;
-        screen.draw_rectangle(x,7+y+idx*7, 8, 8, Pixel_state::PIXEL_ONE, fill);
+    drawn_segments = get_segments();
+    drawn_mode = mode;
+    // the segments, and the signal LED to their left
+    add_damage(x-5, y, 13, segment_y(1)+8-y);
+
+    for (uint8_t segment = 0; segment <= 12; segment++) {
+        Pixel_state fill = (drawn_segments & (1u << segment)) ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO;
+        screen.draw_rectangle(x, segment_y(segment), 8, 8, Pixel_state::PIXEL_ONE, fill);
+    }
+    // The signal LED is just left of the bottom meter segment
+    if (mode & signal_led_mode) {
+        screen.draw_centered_circle(x-3, y+7+11*7+4, 2, Pixel_state::PIXEL_ONE,
+            (drawn_segments & signal_led_segment) ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO);
+    }
+    else {
+        screen.draw_rectangle(x-5, y+7+11*7+2, 5, 5, Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
+    }
+}
+
+void rppicomidi::Mc_meter::set_mode(uint8_t mode_)
+{
+    mode_ &= (signal_led_mode | peak_hold_mode | lcd_meter_mode);
+    if (mode_ != mode) {
+        mode = mode_;
+        if ((mode & peak_hold_mode) == 0)
+            peak = 0;
+        mark_dirty();
     }
 }
 
 void rppicomidi::Mc_meter::set_value(uint8_t value_, bool overload_)
 {
+    // the DAW repeats the meter level to hold it; only a new level needs a draw
+    bool changed = value_ != value || overload_ != overload || value_ > peak;
     value = value_;
+    if (value > peak)
+        peak = value;
     overload = overload_;
     time_last_value_set = get_absolute_time();
-    draw();
+    if (changed)
+        mark_dirty();
 }
 
 void rppicomidi::Mc_meter::set_value_by_channel_pressure(uint8_t message)
 {
     uint8_t val = message & 0xF;
     if (val == 0xF) {
+        // clearing the overload also clears the held peak
+        if (peak != 0) {
+            peak = 0;
+            mark_dirty();
+        }
         clear_overload();
     }
     else if (val == 0xE) {
@@ -76,8 +160,10 @@ void rppicomidi::Mc_meter::task()
         
         int64_t diff = absolute_time_diff_us(time_last_value_set, now);
         if (diff > 300000 /* 300 ms */) {
+            // decay one segment every 300 ms
             --value;
-            draw();
+            time_last_value_set = now;
+            mark_dirty();
         }
     }
 }
\ No newline at end of file
@@ -27,10 +27,10 @@
  */
 #pragma once
 #include "mono_graphics_lib.h"
-#include "drawable.h"
+#include "mc_drawable.h"
 #include "pico/stdlib.h"
 namespace rppicomidi {
-class Mc_meter : public Drawable
+class Mc_meter : public Mc_drawable
 {
 public:
     Mc_meter(Mono_graphics& screen_, uint8_t x_, uint8_t y_, uint8_t meter_channel_);
@@ -48,10 +48,10 @@ public:
     void set_value(uint8_t value, bool overload);
 
     /**
-     * @brief clear the overload flag and redraw
+     * @brief clear the overload flag
      * 
      */
-    void clear_overload() { overload = false; draw(); }
+    void clear_overload() { if (overload) { overload = false; mark_dirty(); } }
 
     /**
      * @brief Set the value by channel pressure object
@@ -65,6 +65,21 @@ public:
      */
     void set_value_by_channel_pressure(uint8_t message);
 
+    // Mackie Control channel meter mode bits
+    static const uint8_t signal_led_mode = 1;  // light the signal LED when the meter level is not 0
+    static const uint8_t peak_hold_mode = 2;   // keep the highest segment lit until the overload flag is cleared
+    static const uint8_t lcd_meter_mode = 4;   // show the meter level
+
+    /**
+     * @brief Set the meter mode from the mode byte of a Mackie Control
+     * channel meter mode message (F0 00 00 66 14 20 0i 0m F7)
+     *
+     * @param mode_ a bitwise OR of signal_led_mode, peak_hold_mode and lcd_meter_mode
+     */
+    void set_mode(uint8_t mode_);
+
+    uint8_t get_mode() const { return mode; }
+
     /**
      * @brief draw the meter to the screen buffer
      * 
@@ -79,6 +94,12 @@ public:
      * once per 300ms.
      */
     void task();
+protected:
+    /**
+     * @brief fill or clear only the segments, the overload box
+     * and the signal LED whose state changed since the last draw
+     */
+    void draw_dirty() final;
 private:
     Mc_meter() = delete;
     Mc_meter(Mc_meter&) = delete;
@@ -87,7 +108,30 @@ private:
     uint8_t x,y;
     uint8_t meter_channel;
     uint8_t value;
+    uint8_t peak;   // the highest value since the last overload clear
     bool overload;
+    uint8_t mode;
     absolute_time_t time_last_value_set;
+    uint16_t drawn_segments;    // the segment bits last drawn (see get_segments())
+    uint8_t drawn_mode;         // the mode last drawn
+
+    static const uint16_t overload_segment = 1; // bit 0 is the overload box; bits 1-12 are the level segments
+    /**
+     * @brief level_segments[level] has the bits of the lit level segments for level 0-12
+     */
+    static const uint16_t level_segments[13];
+    static const uint16_t signal_led_segment = 1 << 13;
+    /**
+     * @brief get the bits of the overload box, the level segments
+     * and the signal LED that should be lit
+     */
+    uint16_t get_segments() const;
+
+    /**
+     * @brief get the y coordinate of the top of a level segment
+     *
+     * @param segment the segment number 1-12 or 0 for the overload box
+     */
+    int segment_y(uint8_t segment) const { return segment == 0 ? y : 7+y+(12-segment)*7; }
 };
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+/**
+ * @file mc_mtc_decoder.cpp
+ * @brief This class decodes MIDI Time Code quarter frame and full frame
+ * messages and runs a local clock between them
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#include <cstring>
+#include "mc_mtc_decoder.h"
+
+constexpr uint8_t rppicomidi::Mc_mtc_decoder::fps[4];
+constexpr uint32_t rppicomidi::Mc_mtc_decoder::frame_ns[4];
+
+rppicomidi::Mc_mtc_decoder::Mc_mtc_decoder() :
+    pieces_received{0}, rate{3}, running{false}, anchor_frame{0}, current_frame{0}
+{
+    memset(pieces, 0, sizeof(pieces));
+    anchor_time = get_absolute_time();
+    last_message_time = nil_time;
+}
+
+void rppicomidi::Mc_mtc_decoder::push_quarter_frame(uint8_t data)
+{
+    uint8_t piece = (data >> 4) & 0x7;
+    last_message_time = get_absolute_time();
+    if (piece == 0)
+        pieces_received = 0;
+    pieces[piece] = data & 0xF;
+    pieces_received |= (1 << piece);
+    if (piece == 7 && pieces_received == all_pieces) {
+        rate = (pieces[7] >> 1) & 0x3;
+        uint8_t hours = ((pieces[7] & 0x1) << 4) | pieces[6];
+        uint8_t minutes = (pieces[5] << 4) | pieces[4];
+        uint8_t seconds = (pieces[3] << 4) | pieces[2];
+        uint8_t frames = (pieces[1] << 4) | pieces[0];
+        set_time(hours, minutes, seconds, frames, true);
+        // The time was for piece 0, which was sent 2 frames ago
+        anchor_frame += 2;
+        pieces_received = 0;
+    }
+}
+
+bool rppicomidi::Mc_mtc_decoder::push_full_frame(const uint8_t* sysex, int len_sysex)
+{
+    if (len_sysex != 10 || sysex[0] != 0xF0 || sysex[1] != 0x7F || sysex[3] != 0x01 || sysex[4] != 0x01 || sysex[9] != 0xF7)
+        return false;
+    last_message_time = get_absolute_time();
+    rate = (sysex[5] >> 5) & 0x3;
+    set_time(sysex[5] & 0x1F, sysex[6], sysex[7], sysex[8], false);
+    pieces_received = 0;
+    current_frame = UINT32_MAX; // make sure the next task() reports the new time
+    return true;
+}
+
+void rppicomidi::Mc_mtc_decoder::set_time(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames, bool running_)
+{
+    anchor_frame = ((hours * 60ul + minutes) * 60ul + seconds) * fps[rate] + frames;
+    anchor_time = get_absolute_time();
+    running = running_;
+}
+
+bool rppicomidi::Mc_mtc_decoder::task()
+{
+    uint32_t frame = anchor_frame;
+    if (running) {
+        int64_t elapsed_us = absolute_time_diff_us(anchor_time, get_absolute_time());
+        uint32_t elapsed_frames = (uint32_t)((elapsed_us * 1000) / frame_ns[rate]);
+        // The next complete set of quarter frames arrives after 2 frames. If it
+        // does not, transport stopped; don't run ahead of the DAW.
+        if (elapsed_frames > 2)
+            elapsed_frames = 2;
+        frame += elapsed_frames;
+    }
+    bool changed = frame != current_frame;
+    current_frame = frame;
+    return changed;
+}
+
+bool rppicomidi::Mc_mtc_decoder::is_active() const
+{
+    return !is_nil_time(last_message_time) && absolute_time_diff_us(last_message_time, get_absolute_time()) < active_timeout_us;
+}
+
+void rppicomidi::Mc_mtc_decoder::get_time(uint8_t& hours, uint8_t& minutes, uint8_t& seconds, uint8_t& frames) const
+{
+    uint32_t frame = current_frame;
+    frames = frame % fps[rate];
+    frame /= fps[rate];
+    seconds = frame % 60;
+    frame /= 60;
+    minutes = frame % 60;
+    hours = (frame / 60) % 24;
+}
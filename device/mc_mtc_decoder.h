@@ -0,0 +1,97 @@
+/**
+ * @file mc_mtc_decoder.h
+ * @brief This class decodes MIDI Time Code quarter frame and full frame
+ * messages and runs a local clock between them
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#pragma once
+#include <cstdint>
+#include "pico/time.h"
+namespace rppicomidi {
+class Mc_mtc_decoder
+{
+public:
+    Mc_mtc_decoder();
+
+    virtual ~Mc_mtc_decoder() = default;
+
+    /**
+     * @brief decode the data byte of a MIDI Time Code quarter frame
+     * message (F1 0nnn dddd)
+     *
+     * The time is updated each time all 8 pieces arrive in order. The
+     * local clock runs while quarter frames keep arriving.
+     * @param data the data byte
+     */
+    void push_quarter_frame(uint8_t data);
+
+    /**
+     * @brief decode a MIDI Time Code full frame message
+     * (F0 7F cc 01 01 hr mn sc fr F7). The local clock stops at the new time.
+     *
+     * @param sysex the complete sysex message, including F0 and F7
+     * @param len_sysex the number of bytes in the message
+     * @return true if the message was a full frame message
+     */
+    bool push_full_frame(const uint8_t* sysex, int len_sysex);
+
+    /**
+     * @brief advance the local clock
+     *
+     * @return true if the time in hours, minutes, seconds and frames changed
+     */
+    bool task();
+
+    /**
+     * @brief return true if an MTC message arrived recently
+     */
+    bool is_active() const;
+
+    /**
+     * @brief get the current time
+     *
+     * @note the frame count does not skip the dropped frame numbers of 29.97 fps
+     * drop frame timecode; the DAW resynchronizes the time every 2 frames while running
+     */
+    void get_time(uint8_t& hours, uint8_t& minutes, uint8_t& seconds, uint8_t& frames) const;
+private:
+    /**
+     * @brief restart the local clock from the specified time
+     */
+    void set_time(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames, bool running_);
+
+    static const uint8_t all_pieces = 0xFF;
+    static const uint32_t active_timeout_us = 1000000;  // MTC stops driving the display after 1s without MTC
+    static constexpr uint8_t fps[4] = {24, 25, 30, 30}; // nominal frames per second by rate code
+    static constexpr uint32_t frame_ns[4] = {41666667, 40000000, 33366667, 33333333}; // frame duration by rate code
+    uint8_t pieces[8];          // quarter frame data nibbles by piece number
+    uint8_t pieces_received;    // bit n is set if piece n was received since the last piece 0
+    uint8_t rate;               // the MTC rate code 0-3
+    bool running;               // true if the local clock is running
+    uint32_t anchor_frame;      // the frame count at anchor_time
+    absolute_time_t anchor_time;
+    uint32_t current_frame;     // the frame count last returned by task()
+    absolute_time_t last_message_time;
+};
+}
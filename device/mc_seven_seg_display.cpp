@@ -37,7 +37,10 @@ rppicomidi::Mc_seven_seg_display::Mc_seven_seg_display(View_manager& view_manage
     smpte_led{smpte_led_}, beats_led{beats_led_},
     nbeat_digits{3}, nbars_digits{2}, nsubs_digits{2}, nticks_digits{3}, nmode_digits{2},
     setup_menu{setup_menu_},
-    chan_button_mode{MC_BTN_FN_SEL}
+    chan_button_mode{MC_BTN_FN_SEL}, mtc_active{false},
+    // The master fader goes between the mode digits and the channel strip button mode
+    master_fader{screen, (uint8_t)(seven_seg_font.width*2+2), (uint8_t)(screen.get_screen_height()- seven_seg_font.height - label_font.height),
+        (uint8_t)(seven_seg_font.width*4-4), (uint8_t)(seven_seg_font.height + label_font.height), &label_font}
 {
     memset(digits, ' ', sizeof(digits));
 }
@@ -69,6 +72,14 @@ void rppicomidi::Mc_seven_seg_display::draw()
         uint8_t mode_y = screen.get_screen_height()- seven_seg_font.height - label_font.height;
         uint8_t mode_x = seven_seg_font.width * 6;
         screen.draw_string(seven_seg_font, mode_x, mode_y, chan_but_mode_names[chan_button_mode], 4, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+        master_fader.draw();
+    }
+}
+
+void rppicomidi::Mc_seven_seg_display::draw_changes()
+{
+    if (view_manager.is_current_view(this)) {
+        master_fader.draw_if_dirty();
     }
 }
 
@@ -157,6 +168,10 @@ bool rppicomidi::Mc_seven_seg_display::set_digit_by_mc_cc(uint8_t byte1, uint8_t
     bool success = true;
     if ((byte1 & 0xf0) == 0x40) {
         uint8_t digit = byte1 & 0xf;
+        if (digit < 10 && mtc_active && !is_beats_mode()) {
+            // MIDI Time Code is driving the Timecode display
+            return success;
+        }
         char symbol = ' ';
         byte2 &= 0x3f; //strip off the decimal point
         if (digit < 12) {
@@ -205,6 +220,19 @@ bool rppicomidi::Mc_seven_seg_display::set_digits_by_mc_sysex(uint8_t* sysex, in
     return success;
 }
 
+void rppicomidi::Mc_seven_seg_display::set_timecode(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames)
+{
+    if (is_beats_mode())
+        return;
+    // digit 9 is the leftmost hours digit; digit 0 is right of the frames
+    const char tc[10] = {' ', (char)('0'+frames%10), (char)('0'+frames/10), (char)('0'+seconds%10), (char)('0'+seconds/10),
+        (char)('0'+minutes%10), (char)('0'+minutes/10), (char)('0'+hours%10), (char)('0'+hours/10), ' '};
+    for (uint8_t digit = 0; digit < sizeof(tc); digit++) {
+        if (digits[digit] != tc[digit])
+            set_seven_seg_digit(digit, tc[digit]);
+    }
+}
+
 bool rppicomidi::Mc_seven_seg_display::set_smpte_beats_by_mc_note(uint8_t byte1, uint8_t byte2)
 {
     bool success = true;
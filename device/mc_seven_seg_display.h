@@ -29,6 +29,7 @@
 #pragma once
 #include "mono_graphics_lib.h"
 #include "view_manager.h"
+#include "mc_fader.h"
 namespace rppicomidi {
 class Mc_seven_seg_display : public View
 {
@@ -97,6 +98,38 @@ public:
      */
     bool set_smpte_beats_by_mc_note(uint8_t byte1, uint8_t byte2);
 
+    /**
+     * @brief Display a MIDI Time Code time on the Timecode/BBT display.
+     * Only digits that change are drawn.
+     *
+     * @note this does nothing if the BEATS LED is on and the SMPTE LED is off
+     */
+    void set_timecode(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames);
+
+    /**
+     * @brief set to true while MIDI Time Code drives the Timecode/BBT display.
+     * Timecode/BBT digit CC and SysEx messages are ignored unless the display
+     * is in BEATS mode.
+     */
+    void set_mtc_active(bool active) { mtc_active = active; }
+
+    bool is_beats_mode() const { return beats_led && !smpte_led; }
+
+    /**
+     * @brief Set the master fader position from the data bytes of
+     * a Mackie Control channel 9 pitch bend message
+     *
+     * @param lsb the least significant 7 bits of the position
+     * @param msb the most significant 7 bits of the position
+     */
+    void set_master_fader_by_pitch_bend(uint8_t lsb, uint8_t msb) { master_fader.set_position_by_pitch_bend(lsb, msb); }
+
+    /**
+     * @brief draw display elements that are updated at most once per
+     * render cycle. Call before rendering the screen.
+     */
+    void draw_changes();
+
     void set_chan_button_mode(uint8_t mode) {
         if (mode < 5) chan_button_mode = mode;
         if (view_manager.is_current_view(this)) draw();
@@ -119,6 +152,8 @@ private:
     char digits[12];
     View& setup_menu;
     uint8_t chan_button_mode;
+    bool mtc_active;
+    Mc_fader master_fader;
     static constexpr const char *chan_but_mode_names[5] = {"SEL ", "SOLO", "MUTE", "REC ", "VPOT"};
 };
 }
\ No newline at end of file
@@ -27,96 +27,166 @@
  * SOFTWARE. * 
  */
 
+#include <cstdio>
+#include <cassert>
+#include "mc_vpot_display.h"
+#ifdef MC_VPOT_BENCHMARK
 #include <cmath>
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
+#include "hardware/clocks.h"
+#endif
 
-#include "mc_vpot_display.h"
+namespace rppicomidi {
+/**
+ * @brief compute whether the ring LED for value_led 1-11 is on
+ * for a given mode and value; the result fills the led_masks table
+ */
+static constexpr bool vpot_led_is_on(Vpot_mode mode, uint8_t value, uint8_t value_led)
+{
+    if (value == 0)
+        return false;
+    switch (mode) {
+        case Vpot_mode::SINGLE_DOT:
+            return value_led == value;
+        case Vpot_mode::BOOST_CUT:
+            if (value > 6)
+                return value_led <= value && value_led >= 6; // boost
+            return value_led >= value && value_led <= 6; // cut (or the center LED for value 6)
+        case Vpot_mode::WRAP:
+            return value_led <= value;
+        case Vpot_mode::SPREAD:
+        {
+            uint8_t delta = value > 6 ? value - 6 : 6 - value;
+            return value_led >= 6 - delta && value_led <= 6 + delta;
+        }
+    }
+    return false;
+}
+
+static constexpr uint16_t vpot_led_mask(Vpot_mode mode, uint8_t value)
+{
+    uint16_t mask = 0;
+    for (uint8_t led = 0; led < 11; led++) {
+        if (vpot_led_is_on(mode, value, led + 1))
+            mask |= 1u << led;
+    }
+    return mask;
+}
+
+#define VPOT_MASKS(mode) { \
+    vpot_led_mask(mode, 0), vpot_led_mask(mode, 1), vpot_led_mask(mode, 2), vpot_led_mask(mode, 3), \
+    vpot_led_mask(mode, 4), vpot_led_mask(mode, 5), vpot_led_mask(mode, 6), vpot_led_mask(mode, 7), \
+    vpot_led_mask(mode, 8), vpot_led_mask(mode, 9), vpot_led_mask(mode, 10), vpot_led_mask(mode, 11) }
+
+constexpr uint16_t Mc_vpot_display::led_masks[4][12] = {
+    VPOT_MASKS(Vpot_mode::SINGLE_DOT),
+    VPOT_MASKS(Vpot_mode::BOOST_CUT),
+    VPOT_MASKS(Vpot_mode::WRAP),
+    VPOT_MASKS(Vpot_mode::SPREAD),
+};
+#undef VPOT_MASKS
+
+// LEDs every 22.5 degrees from -22.5 to 202.5 degrees: -trunc(22*cos(angle)), -trunc(22*sin(angle))
+constexpr int8_t Mc_vpot_display::led_dx[num_leds] = {-20, -22, -20, -15, -8, 0, 8, 15, 20, 22, 20};
+constexpr int8_t Mc_vpot_display::led_dy[num_leds] = {8, 0, -8, -15, -20, -22, -20, -15, -8, 0, 8};
+}
 
 rppicomidi::Mc_vpot_display::Mc_vpot_display(Mono_graphics& screen_, uint8_t x_, uint8_t y_, Vpot_mode initial_mode_, 
         uint8_t initial_value_, bool initial_p_) :
     screen{screen_}, x0{x_}, y0{y_}, led_r{3}, outline_r{12}, led_placement_r{(uint8_t)(outline_r+ led_r + 7)}, p_led_placement_r{(uint8_t)(outline_r+led_r+1)},
     width{(uint8_t)((led_placement_r + led_r)*2)}, height{(uint8_t)(led_placement_r + p_led_placement_r + 2*led_r)}, 
     center_x{(uint8_t)(x_+width/2)}, center_y{(uint8_t)(y_+height/2)},
-    mode{initial_mode_}, value{initial_value_}, p_led_on{initial_p_}
+    mode{initial_mode_}, value{initial_value_}, p_led_on{initial_p_}, drawn_leds{0}, drawn_p_led_on{false}
 {
+    assert(led_placement_r == 22); // led_dx and led_dy are for this radius
     draw();
 }
 
+void rppicomidi::Mc_vpot_display::draw_ring_led(uint8_t led, bool is_on)
+{
+    add_damage(center_x + led_dx[led] - led_r, center_y + led_dy[led] - led_r, 2*led_r+1, 2*led_r+1);
+    screen.draw_centered_circle(center_x + led_dx[led], center_y + led_dy[led], led_r, Pixel_state::PIXEL_ONE,
+        is_on ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO);
+}
+
 void rppicomidi::Mc_vpot_display::draw()
 {
+    add_damage(x0, y0, width, height);
     screen.draw_centered_circle(center_x, center_y, outline_r, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_TRANSPARENT); // outline
     screen.draw_centered_circle(center_x, center_y, outline_r/2, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE); // center shaft
     screen.draw_centered_circle(center_x, center_y+p_led_placement_r, led_r, Pixel_state::PIXEL_ONE, 
         p_led_on ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO); // p LED
-    // For spread mode
-    uint8_t delta;
-    uint8_t min_range=0;
-    uint8_t max_range=0;
-    if (mode == Vpot_mode::SPREAD) {
-        delta = abs(6 - value);
-        min_range = 6-delta;
-        max_range = 6+delta;
+    drawn_p_led_on = p_led_on;
+    drawn_leds = led_masks[static_cast<uint8_t>(mode)][value];
+    for (uint8_t led = 0; led < num_leds; led++) {
+        draw_ring_led(led, (drawn_leds & (1u << led)) != 0);
     }
+}
 
-    for (int angle_mult = -1; angle_mult <=9; angle_mult++) {
-        float angle = (M_PI / 8.0) * static_cast<float>(angle_mult);
-        float x0 = std::cos(angle) * led_placement_r;
-        float y0 = std::sin(angle) * led_placement_r;
-        uint8_t led_x = uint8_t((int)center_x - (int)x0);
-        uint8_t led_y = uint8_t((int)center_y - (int)y0);
-        Pixel_state state = Pixel_state::PIXEL_ZERO;
-        uint8_t value_led = angle_mult + 2;
-        
-        if (value != 0) {
-            switch (mode) {
-                case Vpot_mode::SINGLE_DOT:
-                    if (value_led == value)
-                        state = Pixel_state::PIXEL_ONE;
-                    break;
-                case Vpot_mode::BOOST_CUT:
-                    if (value == 6) {
-                        if (value_led == value)
-                            state = Pixel_state::PIXEL_ONE;
-                    }
-                    if (value > 6) {
-                        // boost
-                        if (value_led <= (value) && value_led >= 6)
-                            state = Pixel_state::PIXEL_ONE;
-                    }
-                    else {
-                        // cut
-                        if (value_led >= value && value_led <= 6)
-                            state = Pixel_state::PIXEL_ONE;
-                    }
-                    break;
-                case Vpot_mode::WRAP:
-                    if (value_led <= (value))
-                        state = Pixel_state::PIXEL_ONE;
-                    break;
-                case Vpot_mode::SPREAD:
-                    if (value == 6) {
-                        if (value_led == value)
-                            state = Pixel_state::PIXEL_ONE;
-                    }
-                    else {
-                        if (value_led >= min_range && value_led <= max_range)
-                            state = Pixel_state::PIXEL_ONE;
-                    }
-                    break;
-            }
+void rppicomidi::Mc_vpot_display::draw_dirty()
+{
+    if (p_led_on != drawn_p_led_on) {
+        add_damage(center_x - led_r, center_y + p_led_placement_r - led_r, 2*led_r+1, 2*led_r+1);
+        screen.draw_centered_circle(center_x, center_y+p_led_placement_r, led_r, Pixel_state::PIXEL_ONE,
+            p_led_on ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO); // p LED
+        drawn_p_led_on = p_led_on;
+    }
+    uint16_t leds = led_masks[static_cast<uint8_t>(mode)][value];
+    uint16_t changed = leds ^ drawn_leds;
+    for (uint8_t led = 0; changed != 0; led++, changed >>= 1) {
+        if (changed & 1)
+            draw_ring_led(led, (leds & (1u << led)) != 0);
+    }
+    drawn_leds = leds;
+}
+
+#ifdef MC_VPOT_BENCHMARK
+void rppicomidi::Mc_vpot_display::run_benchmark(Mono_graphics& screen_)
+{
+    const uint32_t nupdates = 1000;
+    Mc_vpot_display vpot{screen_, 0, 52, Vpot_mode::BOOST_CUT, 0, false};
+    // Per-LED trigonometry, as the ring used to be drawn
+    uint64_t start = time_us_64();
+    for (uint32_t update = 0; update < nupdates; update++) {
+        uint8_t cc_value = update % 0x40;
+        vpot.set_by_cc_value(cc_value);
+        uint16_t leds = led_masks[static_cast<uint8_t>(vpot.mode)][vpot.value];
+        for (int angle_mult = -1; angle_mult <=9; angle_mult++) {
+            float angle = (M_PI / 8.0) * static_cast<float>(angle_mult);
+            float led_x0 = std::cos(angle) * vpot.led_placement_r;
+            float led_y0 = std::sin(angle) * vpot.led_placement_r;
+            screen_.draw_centered_circle((int)vpot.center_x - (int)led_x0, (int)vpot.center_y - (int)led_y0, vpot.led_r,
+                Pixel_state::PIXEL_ONE, (leds & (1u << (angle_mult + 1))) ? Pixel_state::PIXEL_ONE:Pixel_state::PIXEL_ZERO);
         }
-        screen.draw_centered_circle(led_x, led_y, led_r, Pixel_state::PIXEL_ONE, state);
     }
+    uint64_t trig_us = time_us_64() - start;
+    // Table lookups, drawing only the LEDs that changed
+    start = time_us_64();
+    for (uint32_t update = 0; update < nupdates; update++) {
+        vpot.set_by_cc_value(update % 0x40);
+        vpot.draw_if_dirty();
+    }
+    uint64_t table_us = time_us_64() - start;
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    printf("VPot update: trigonometry %lu cycles, tables %lu cycles\r\n",
+        (uint32_t)(trig_us * mhz / nupdates), (uint32_t)(table_us * mhz / nupdates));
+    screen_.clear_canvas();
 }
+#endif
 
 void rppicomidi::Mc_vpot_display::set_by_cc_value(uint8_t cc_value)
 {
-    p_led_on = (cc_value & 0x40) != 0;
-    mode = static_cast<Vpot_mode>((cc_value >>4) & 3);
-    value = cc_value & 0xf;
-    if (value > 11)
-        value = 0;
-    draw();
+    bool p_led_on_ = (cc_value & 0x40) != 0;
+    Vpot_mode mode_ = static_cast<Vpot_mode>((cc_value >>4) & 3);
+    uint8_t value_ = cc_value & 0xf;
+    if (value_ > 11)
+        value_ = 0;
+    if (p_led_on_ != p_led_on || mode_ != mode || value_ != value) {
+        p_led_on = p_led_on_;
+        mode = mode_;
+        value = value_;
+        mark_dirty();
+    }
 }
\ No newline at end of file
@@ -29,7 +29,7 @@
 
 #pragma once
 #include "mono_graphics_lib.h"
-#include "drawable.h"
+#include "mc_drawable.h"
 namespace rppicomidi {
 
 enum class Vpot_mode {
@@ -39,19 +39,30 @@ enum class Vpot_mode {
     SPREAD=3,
 };
 
-class Mc_vpot_display : public Drawable
+class Mc_vpot_display : public Mc_drawable
 {
 public:
     Mc_vpot_display(Mono_graphics& screen_, uint8_t x_, uint8_t y_, Vpot_mode initial_mode_, uint8_t initial_value_, bool initial_p_);
     virtual ~Mc_vpot_display() = default;
 
     void draw() final;
+
+#ifdef MC_VPOT_BENCHMARK
+    /**
+     * @brief time VPot LED ring updates drawn with the LED position and
+     * LED mask tables against updates drawn with per-LED trigonometry and
+     * print the average CPU cycles per update
+     *
+     * @param screen_ a screen the benchmark may draw on
+     */
+    static void run_benchmark(Mono_graphics& screen_);
+#endif
     uint8_t get_width() {return width;}
     uint8_t get_height() {return height;}
     void set_mode_and_value(Vpot_mode mode_, uint8_t value_) {
-        mode = mode_; value = value_; draw();
+        mode = mode_; value = value_ > 11 ? 0 : value_; mark_dirty();
     }
-    void set_p(bool is_on) { p_led_on = is_on; draw(); }
+    void set_p(bool is_on) { p_led_on = is_on; mark_dirty(); }
 
     /**
      * @brief Set the by Mackie Control VPot LED CC message value
@@ -62,6 +73,11 @@ public:
      */
     void set_by_cc_value(uint8_t cc_value);
 protected:
+    /**
+     * @brief redraw only the ring LEDs and the p LED whose state
+     * changed since the last draw
+     */
+    void draw_dirty() final;
     Mc_vpot_display() = delete;
     Mc_vpot_display(Mc_vpot_display&) = delete;
 
@@ -78,6 +94,21 @@ protected:
     Vpot_mode mode; // how to display the values on the main 11 VPot "LEDs"
     uint8_t value;  // the value 0-11
     bool p_led_on;  // the bottom center "LED" state
+    uint16_t drawn_leds; // the ring LED mask last drawn
+    bool drawn_p_led_on; // the p LED state last drawn
+
+    static const uint8_t num_leds = 11;
+    /**
+     * @brief the ring LED center offsets from the VPot center for
+     * LED placement radius 22 (LED 0 is the LED for value 1)
+     */
+    static const int8_t led_dx[num_leds];
+    static const int8_t led_dy[num_leds];
+    /**
+     * @brief led_masks[mode][value] has bit n set if ring LED n is on
+     */
+    static const uint16_t led_masks[4][12];
+    void draw_ring_led(uint8_t led, bool is_on);
 };
 
 } // namespace rppicomidi
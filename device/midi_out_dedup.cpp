@@ -0,0 +1,72 @@
+/**
+ * @file midi_out_dedup.cpp
+ * @brief This class drops MIDI messages to the control surface that would
+ * not change the state of the surface
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#include <cstring>
+#include "midi_out_dedup.h"
+
+rppicomidi::Midi_out_dedup::Midi_out_dedup() : nsuppressed_bytes{0}
+{
+    invalidate();
+}
+
+void rppicomidi::Midi_out_dedup::invalidate()
+{
+    memset(notes, unknown_value, sizeof(notes));
+    memset(ccs, unknown_value, sizeof(ccs));
+    last_refresh = get_absolute_time();
+}
+
+bool rppicomidi::Midi_out_dedup::is_redundant(uint8_t cable_num, const uint8_t* message)
+{
+    uint8_t* value;
+    if (message[0] == 0x80) {
+        notes[cable_num & 0xF][message[1] & 0x7F] = unknown_value;
+        return false;
+    }
+    if (message[0] == 0x90) {
+        value = &notes[cable_num & 0xF][message[1] & 0x7F];
+    }
+    else if (message[0] == 0xB0) {
+        value = &ccs[cable_num & 0xF][message[1] & 0x7F];
+    }
+    else {
+        return false;
+    }
+    if (*value == message[2]) {
+        nsuppressed_bytes += 3;
+        return true;
+    }
+    *value = message[2];
+    return false;
+}
+
+void rppicomidi::Midi_out_dedup::task()
+{
+    if (absolute_time_diff_us(last_refresh, get_absolute_time()) > refresh_interval_ms*1000ll) {
+        invalidate();
+    }
+}
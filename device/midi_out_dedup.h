@@ -0,0 +1,78 @@
+/**
+ * @file midi_out_dedup.h
+ * @brief This class drops MIDI messages to the control surface that would
+ * not change the state of the surface
+ * 
+ * Copyright (c) 2023 rppicomidi
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ */
+#pragma once
+#include <cstdint>
+#include "pico/time.h"
+
+// Build with the MIDI_OUT_DEDUP CMake option ON to use this class
+
+namespace rppicomidi {
+class Midi_out_dedup
+{
+public:
+    Midi_out_dedup();
+
+    /**
+     * @brief check if a message repeats the last value sent
+     *
+     * Only MIDI channel 1 note on and control change messages are checked;
+     * Mackie Control uses them for LED and LED ring states. The message
+     * value is remembered if it is not redundant. A note on with velocity 0
+     * (how MC turns an LED off) is a value like any other. A note off
+     * (0x80) is never redundant and forgets the note's value.
+     * Call this only for cables that have an MC unit.
+     * @param cable_num the virtual cable 0-15 the message goes out on
+     * @param message the 3-byte MIDI message
+     * @return true if the message would not change the surface and can be dropped
+     */
+    bool is_redundant(uint8_t cable_num, const uint8_t* message);
+
+    /**
+     * @brief forget all values sent so the next message of every kind is sent
+     */
+    void invalidate();
+
+    /**
+     * @brief forget all values sent once every refresh_interval_ms
+     * in case the surface lost its state
+     */
+    void task();
+
+    /**
+     * @brief Get the number of bytes not sent because they were redundant
+     */
+    uint32_t get_suppressed_bytes() const { return nsuppressed_bytes; }
+private:
+    static const uint8_t unknown_value = 0xFF; // never matches a 7-bit data byte
+    static const uint32_t refresh_interval_ms = 10000;
+    uint8_t notes[16][128];     // the last note on velocity by cable and note number
+    uint8_t ccs[16][128];       // the last control change value by cable and CC number
+    uint32_t nsuppressed_bytes;
+    absolute_time_t last_refresh;
+};
+}
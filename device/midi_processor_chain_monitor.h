@@ -0,0 +1,69 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+namespace rppicomidi
+{
+/**
+ * @brief Record that a MIDI processor chain changed so the bridge can
+ * recompute its per-cable bypass bitmaps only when needed
+ *
+ * Call changed() whenever a MIDI processor is created or destroyed and
+ * after loading or clearing the processor settings.
+ */
+class Midi_processor_chain_monitor
+{
+public:
+    // Singleton Pattern
+
+    /**
+     * @brief Get the Instance object
+     *
+     * @return the singleton instance
+     */
+    static Midi_processor_chain_monitor& instance()
+    {
+        static Midi_processor_chain_monitor _instance;  // Guaranteed to be destroyed.
+                                                        // Instantiated on first use.
+        return _instance;
+    }
+    Midi_processor_chain_monitor(Midi_processor_chain_monitor const&) = delete;
+    void operator=(Midi_processor_chain_monitor const&) = delete;
+
+    void changed() { is_changed = true; }
+
+    /**
+     * @brief check for a change and forget it
+     *
+     * @return true if a processor chain changed since the last call
+     */
+    bool take_changed() {
+        bool result = is_changed;
+        is_changed = false;
+        return result;
+    }
+private:
+    Midi_processor_chain_monitor() : is_changed{true} {}
+    bool is_changed;
+};
+}
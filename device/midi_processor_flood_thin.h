@@ -0,0 +1,124 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include "midi_processor.h"
+#include "midi_processor_flood_thin_core.h"
+#include "midi_processor_chain_monitor.h"
+#include "midi_processor_manager.h"
+#include "parson.h"
+#include "tusb.h"
+namespace rppicomidi
+{
+/**
+ * @brief Thin out the fader position and VPot messages the control
+ * surface sends to the DAW (see Midi_processor_flood_thin_core)
+ *
+ * Add it to the MIDI IN direction; it passes MIDI OUT packets unchanged.
+ * The minimum interval is stored with the other MIDI processor settings of
+ * the connected device, so each surface VID/PID keeps its own setting.
+ */
+class Midi_processor_flood_thin : public Midi_processor
+{
+public:
+    Midi_processor_flood_thin() = delete;
+    Midi_processor_flood_thin(uint16_t unique_id_, uint8_t cable_) : Midi_processor{static_getname(), unique_id_}, cable{cable_},
+        min_interval_ms{Midi_processor_flood_thin_core::default_min_interval_ms}, direction{Direction::unknown} {
+        Midi_processor_chain_monitor::instance().changed();
+    }
+    virtual ~Midi_processor_flood_thin() {
+        Midi_processor_flood_thin_core::instance().release(cable);
+        Midi_processor_chain_monitor::instance().changed();
+    }
+    bool process(uint8_t* packet) final {
+        if (direction == Direction::unknown)
+            find_direction();
+        if (direction != Direction::midi_in)
+            return true;
+        return Midi_processor_flood_thin_core::instance().process_midi_in(packet, min_interval_ms, this);
+    }
+
+    void set_min_interval_ms(uint16_t ms) { min_interval_ms = ms; }
+    uint16_t get_min_interval_ms() const { return min_interval_ms; }
+
+    bool serialize_settings(const char* setting_name, char* settings_str, size_t max_settings_str) final
+    {
+        (void)setting_name;
+        bool result = false;
+        JSON_Value* root_value = json_value_init_object();
+        JSON_Object* root_object = json_value_get_object(root_value);
+        json_object_set_number(root_object, min_interval_key, get_min_interval_ms());
+        if (json_serialization_size(root_value) <= max_settings_str) {
+            result = json_serialize_to_buffer(root_value, settings_str, max_settings_str) == JSONSuccess;
+        }
+        json_value_free(root_value);
+        return result;
+    }
+
+    bool deserialize_settings(const char* settings_str) final
+    {
+        bool result = false;
+        JSON_Value* root_value = json_parse_string(settings_str);
+        if (root_value) {
+            JSON_Object* root_object = json_value_get_object(root_value);
+            if (json_object_has_value(root_object, min_interval_key)) {
+                double ms = json_object_get_number(root_object, min_interval_key);
+                if (ms >= 0 && ms <= max_min_interval_ms) {
+                    set_min_interval_ms((uint16_t)ms);
+                    result = true;
+                }
+            }
+            json_value_free(root_value);
+        }
+        return result;
+    }
+
+    static const char* static_getname() { return "Flood Thin"; }
+    static Midi_processor* static_make_new(uint16_t unique_id_, uint8_t cable) {return new Midi_processor_flood_thin(unique_id_, cable); }
+    static const uint16_t max_min_interval_ms = 1000;
+private:
+    /**
+     * @brief look for this processor in the MIDI IN chain of its cable.
+     *
+     * The processor is not in a chain yet when it is constructed, so this
+     * runs on the first packet.
+     */
+    void find_direction() {
+        Midi_processor_manager& manager = Midi_processor_manager::instance();
+        size_t nprocs = manager.get_num_midi_processors(cable, true);
+        for (size_t idx = 0; idx < nprocs; idx++) {
+            if (manager.get_midi_processor_by_index(idx, cable, true) == this) {
+                direction = Direction::midi_in;
+                return;
+            }
+        }
+        direction = Direction::midi_out;
+        TU_LOG1("Flood Thin on cable %u MIDI OUT passes all packets unchanged\r\n", cable);
+    }
+    enum class Direction {unknown, midi_in, midi_out};
+    static constexpr const char* min_interval_key = "min_interval_ms";
+    uint8_t cable;
+    uint16_t min_interval_ms;
+    Direction direction;
+};
+}
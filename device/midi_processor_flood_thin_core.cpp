@@ -0,0 +1,170 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "midi_processor_flood_thin_core.h"
+#include "tusb.h"
+
+rppicomidi::Midi_processor_flood_thin_core::Midi_processor_flood_thin_core() :
+    send_cb{nullptr}, send_context{nullptr}
+{
+    absolute_time_t now = get_absolute_time();
+    for (auto& state: cables) {
+        state.min_interval_ms = 0;
+        state.proc = nullptr;
+        for (auto& fader: state.faders) {
+            fader.pending = false;
+            fader.last_sent = now;
+        }
+        for (auto& vpot: state.vpots) {
+            vpot.delta = 0;
+            vpot.last_sent = now;
+        }
+    }
+}
+
+void rppicomidi::Midi_processor_flood_thin_core::release(uint8_t cable)
+{
+    Cable_state& state = cables[cable & 0xf];
+    if (state.min_interval_ms == 0)
+        return;
+    if (tud_midi_mounted()) {
+        absolute_time_t now = get_absolute_time();
+        for (uint8_t fader = 0; fader < num_faders; fader++) {
+            if (state.faders[fader].pending)
+                send_fader(cable & 0xf, fader, now);
+        }
+        for (uint8_t idx = 0; idx < num_vpots; idx++) {
+            Vpot& vpot = state.vpots[idx];
+            while (vpot.delta != 0) {
+                uint8_t packet[4] = {(uint8_t)(((cable & 0xf) << 4) | 0xB), 0xB0, (uint8_t)(0x10 + idx), 0};
+                take_vpot_delta(vpot, packet, now);
+                if (!send(cable & 0xf, packet))
+                    break;
+            }
+        }
+    }
+    state.min_interval_ms = 0;
+    state.proc = nullptr;
+    for (auto& fader: state.faders)
+        fader.pending = false;
+    for (auto& vpot: state.vpots)
+        vpot.delta = 0;
+}
+
+bool rppicomidi::Midi_processor_flood_thin_core::process_midi_in(uint8_t* packet, uint16_t min_interval_ms, Midi_processor* proc)
+{
+    uint8_t const cable = (packet[0] >> 4) & 0xf;
+    Cable_state& state = cables[cable];
+    state.min_interval_ms = min_interval_ms;
+    state.proc = proc;
+    if (state.min_interval_ms == 0)
+        return true;
+    absolute_time_t now = get_absolute_time();
+    uint8_t const status = packet[1];
+    if ((status & 0xF0) == 0xE0 && (status & 0xF) < num_faders) {
+        // Pitch bend (fader position). Last value wins.
+        Fader& fader = state.faders[status & 0xF];
+        if (interval_expired(state, fader.last_sent, now)) {
+            fader.pending = false;
+            fader.last_sent = now;
+            return true;
+        }
+        fader.pending = true;
+        fader.lsb = packet[2];
+        fader.msb = packet[3];
+        return false;
+    }
+    if (status == 0xB0 && packet[2] >= 0x10 && packet[2] < 0x10 + num_vpots) {
+        // Relative VPot movement: bit 6 set is counter-clockwise; bits 0-5 are the count
+        Vpot& vpot = state.vpots[packet[2] - 0x10];
+        uint8_t const count = packet[3] & 0x3F;
+        vpot.delta += (packet[3] & 0x40) ? -count : count;
+        if (interval_expired(state, vpot.last_sent, now) && vpot.delta != 0) {
+            take_vpot_delta(vpot, packet, now);
+            return true;
+        }
+        return false;
+    }
+    if (status == 0x90 && packet[2] >= 0x68 && packet[2] < 0x68 + num_faders) {
+        // Fader touch. Make sure the DAW has the latest position before the touch state changes.
+        uint8_t const fader = packet[2] - 0x68;
+        if (state.faders[fader].pending)
+            send_fader(cable, fader, now);
+    }
+    return true;
+}
+
+bool rppicomidi::Midi_processor_flood_thin_core::send(uint8_t cable, uint8_t* packet)
+{
+    if (send_cb == nullptr)
+        return true; // nowhere to send it; drop it
+    return send_cb(packet, cables[cable].proc, send_context);
+}
+
+void rppicomidi::Midi_processor_flood_thin_core::send_fader(uint8_t cable, uint8_t fader, absolute_time_t now)
+{
+    Fader& state = cables[cable].faders[fader];
+    uint8_t packet[4] = {(uint8_t)((cable << 4) | 0xE), (uint8_t)(0xE0 | fader), state.lsb, state.msb};
+    if (send(cable, packet)) {
+        state.pending = false;
+        state.last_sent = now;
+    }
+}
+
+void rppicomidi::Midi_processor_flood_thin_core::take_vpot_delta(Vpot& vpot, uint8_t* packet, absolute_time_t now)
+{
+    int16_t delta = vpot.delta;
+    if (delta > 0x3F)
+        delta = 0x3F;
+    else if (delta < -0x3F)
+        delta = -0x3F;
+    vpot.delta -= delta;
+    packet[3] = delta < 0 ? (0x40 | -delta) : delta;
+    vpot.last_sent = now;
+}
+
+void rppicomidi::Midi_processor_flood_thin_core::task()
+{
+    absolute_time_t now = get_absolute_time();
+    for (uint8_t cable = 0; cable < 16; cable++) {
+        Cable_state& state = cables[cable];
+        if (state.min_interval_ms == 0)
+            continue;
+        for (uint8_t fader = 0; fader < num_faders; fader++) {
+            if (state.faders[fader].pending && interval_expired(state, state.faders[fader].last_sent, now)) {
+                send_fader(cable, fader, now);
+            }
+        }
+        for (uint8_t idx = 0; idx < num_vpots; idx++) {
+            Vpot& vpot = state.vpots[idx];
+            if (vpot.delta != 0 && interval_expired(state, vpot.last_sent, now)) {
+                uint8_t packet[4] = {(uint8_t)((cable << 4) | 0xB), 0xB0, (uint8_t)(0x10 + idx), 0};
+                int16_t delta = vpot.delta;
+                take_vpot_delta(vpot, packet, now);
+                if (!send(cable, packet)) {
+                    vpot.delta = delta; // try again later
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,148 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include "pico/time.h"
+#include "midi_processor.h"
+namespace rppicomidi
+{
+/**
+ * @brief Limit how often the surface sends each fader position and
+ * VPot movement to the DAW
+ *
+ * Pitch bend (fader position) messages that arrive too soon after the last
+ * one sent for the same fader are held back and only the latest value is
+ * sent when the interval expires. Relative VPot CC messages that arrive too
+ * soon are summed and the sum is sent when the interval expires. Held back
+ * messages are sent with the send callback, which continues the MIDI IN
+ * processor chain after the processor that held them back.
+ */
+class Midi_processor_flood_thin_core
+{
+public:
+    // Singleton Pattern
+
+    /**
+     * @brief Get the Instance object
+     *
+     * @return the singleton instance
+     */
+    static Midi_processor_flood_thin_core& instance()
+    {
+        static Midi_processor_flood_thin_core _instance;    // Guaranteed to be destroyed.
+                                                    // Instantiated on first use.
+        return _instance;
+    }
+    Midi_processor_flood_thin_core(Midi_processor_flood_thin_core const&) = delete;
+    void operator=(Midi_processor_flood_thin_core const&) = delete;
+
+    /**
+     * @brief process a MIDI IN packet from the surface
+     *
+     * @param packet the USB MIDI packet. The VPot CC value may be replaced with
+     * the sum of the held back movements.
+     * @param min_interval_ms the minimum interval in milliseconds between
+     * messages for the same control
+     * @param proc the MIDI IN processor that calls this function; held back
+     * messages continue the processor chain after it
+     * @return true if the packet should be sent to the DAW now
+     */
+    bool process_midi_in(uint8_t* packet, uint16_t min_interval_ms, Midi_processor* proc);
+
+    /**
+     * @brief send the held back messages whose interval expired to the DAW.
+     * Call frequently.
+     */
+    void task();
+
+    /**
+     * @brief register the function that sends held back messages
+     *
+     * @param send_cb_ called with a held back packet and the processor that
+     * held it back. It returns false if the packet could not be sent now.
+     * @param context_ passed to send_cb_
+     */
+    void register_send_callback(bool (*send_cb_)(uint8_t* packet, Midi_processor* proc, void* context), void* context_) {
+        send_cb = send_cb_;
+        send_context = context_;
+    }
+
+    /**
+     * @brief send any held back messages for a cable now and stop thinning it
+     * until the next MIDI IN packet with a min_interval_ms
+     *
+     * @param cable the virtual cable 0-15
+     */
+    void release(uint8_t cable);
+
+    static const uint16_t default_min_interval_ms = 10;
+private:
+    Midi_processor_flood_thin_core();
+    static const uint8_t num_faders = 9; // 8 channel faders and the master fader
+    static const uint8_t num_vpots = 8;
+    struct Fader {
+        bool pending;
+        uint8_t lsb, msb;
+        absolute_time_t last_sent;
+    };
+    struct Vpot {
+        int16_t delta;          // held back movement; positive is clockwise
+        absolute_time_t last_sent;
+    };
+    struct Cable_state {
+        uint16_t min_interval_ms;
+        Midi_processor* proc;   // the processor that holds messages back
+        Fader faders[num_faders];
+        Vpot vpots[num_vpots];
+    };
+
+    /**
+     * @brief true if a message for a control may be sent now
+     */
+    bool interval_expired(const Cable_state& state, absolute_time_t last_sent, absolute_time_t now) const {
+        return absolute_time_diff_us(last_sent, now) >= (int64_t)state.min_interval_ms * 1000;
+    }
+
+    /**
+     * @brief send a held back packet with the send callback
+     *
+     * @return true if the packet was sent
+     */
+    bool send(uint8_t cable, uint8_t* packet);
+
+    /**
+     * @brief send a held back fader position to the DAW
+     */
+    void send_fader(uint8_t cable, uint8_t fader, absolute_time_t now);
+
+    /**
+     * @brief put as much of the held back VPot movement as fits in one
+     * relative CC value in the packet
+     */
+    void take_vpot_delta(Vpot& vpot, uint8_t* packet, absolute_time_t now);
+    Cable_state cables[16];
+    bool (*send_cb)(uint8_t* packet, Midi_processor* proc, void* context);
+    void* send_context;
+};
+}
@@ -0,0 +1,70 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdio>
+#include "midi_processor_flood_thin_view.h"
+#include "settings_file.h"
+
+rppicomidi::Midi_processor_flood_thin_view::Midi_processor_flood_thin_view(Mono_graphics& screen_, const Rectangle& rect_, Midi_processor* proc_) :
+    View{screen_, rect_}, proc{static_cast<Midi_processor_flood_thin*>(proc_)}, font{screen_.get_font_12()},
+    x{rect_.x}, y{rect_.y}
+{
+}
+
+void rppicomidi::Midi_processor_flood_thin_view::draw()
+{
+    screen.clear_canvas();
+    screen.draw_string(font, x, y, "Min interval", 12, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+    draw_value();
+}
+
+void rppicomidi::Midi_processor_flood_thin_view::draw_value()
+{
+    char value[12];
+    int len = snprintf(value, sizeof(value), "%4u ms", proc->get_min_interval_ms());
+    screen.draw_string(font, x, y + font.height, value, len, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+}
+
+rppicomidi::View::Select_result rppicomidi::Midi_processor_flood_thin_view::on_select(View** new_view)
+{
+    (void)new_view;
+    Settings_file::instance().store();
+    return exit_view;
+}
+
+void rppicomidi::Midi_processor_flood_thin_view::on_increment(uint32_t delta, bool is_shifted)
+{
+    uint32_t ms = proc->get_min_interval_ms() + delta * (is_shifted ? shifted_step_ms : 1);
+    if (ms > Midi_processor_flood_thin::max_min_interval_ms)
+        ms = Midi_processor_flood_thin::max_min_interval_ms;
+    proc->set_min_interval_ms(ms);
+    draw_value();
+}
+
+void rppicomidi::Midi_processor_flood_thin_view::on_decrement(uint32_t delta, bool is_shifted)
+{
+    uint32_t step = delta * (is_shifted ? shifted_step_ms : 1);
+    uint16_t ms = proc->get_min_interval_ms();
+    proc->set_min_interval_ms(step >= ms ? 0 : ms - step);
+    draw_value();
+}
@@ -0,0 +1,59 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include "view_manager.h"
+#include "midi_processor_flood_thin.h"
+namespace rppicomidi
+{
+/**
+ * @brief Set the minimum interval of a Flood Thin processor
+ *
+ * Turn the encoder to change the interval; press select to save the
+ * setting and leave.
+ */
+class Midi_processor_flood_thin_view : public View
+{
+public:
+    Midi_processor_flood_thin_view() = delete;
+    Midi_processor_flood_thin_view(Mono_graphics& screen_, const Rectangle& rect_, Midi_processor* proc_);
+    virtual ~Midi_processor_flood_thin_view() = default;
+    void draw() final;
+    Select_result on_select(View** new_view) final;
+    void on_increment(uint32_t delta, bool is_shifted) final;
+    void on_decrement(uint32_t delta, bool is_shifted) final;
+
+    static View* static_make_new(Mono_graphics& screen_, const Rectangle& rect_, Midi_processor* proc_) {
+        return new Midi_processor_flood_thin_view(screen_, rect_, proc_);
+    }
+private:
+    /**
+     * @brief draw only the interval value
+     */
+    void draw_value();
+    Midi_processor_flood_thin* proc;
+    const Mono_mono_font& font;
+    int x, y;
+    static const uint16_t shifted_step_ms = 10; // the step size when the encoder is turned with shift
+};
+}
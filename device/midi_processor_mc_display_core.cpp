@@ -26,224 +26,436 @@
 #include "tusb.h"
 bool rppicomidi::Midi_processor_mc_display_core::process(uint8_t* rx)
 {
-    uint8_t nread = 0;
-    uint8_t const code_index = rx[0] & 0x0f;
     bool pass_it_on = false;
-    // MIDI 1.0 Table 4-1: Code Index Number Classifications
-    switch(code_index)
-    {
-        case MIDI_CIN_MISC:
-        case MIDI_CIN_CABLE_EVENT:
-            // These are reserved and unused, possibly issue somewhere, skip this packet
-            break;
-
-        case MIDI_CIN_SYSEX_END_1BYTE:
-        case MIDI_CIN_1BYTE_DATA:
-            nread = 1;
-            break;
-
-        case MIDI_CIN_SYSCOM_2BYTE     :
-        case MIDI_CIN_SYSEX_END_2BYTE  :
-        case MIDI_CIN_PROGRAM_CHANGE   :
-        case MIDI_CIN_CHANNEL_PRESSURE :
-            nread = 2;
-            break;
-
-        default:
-            nread = 3;
-            break;
+    uint8_t const cable = (rx[0] >> 4) & 0xf;
+    if (cable_unit[cable] == no_unit) {
+        // not an MC unit cable
+        return true;
+    }
+    Mc_unit& unit = units[cable_unit[cable]];
+    if (unit.num_strips == 0) {
+        // nothing to show this unit on
+        return true;
     }
-    bool success = false;
-    int jdx;
-    int dropped_sysex = 0;
+    Sysex_stream& stream = sysex_streams[cable];
     switch(rx[1]) {
         case 0x90: // Note on (LED control message)
             // Note message, channel 1
-            success = seven_seg->set_smpte_beats_by_mc_note(rx[2], rx[3]);
-            if (!success) {
-                for (int chan = 0; !success && chan < num_chan_displays; chan++) {
-                    success = channel_disp[chan]->push_midi_message(rx+1, nread);
-                }
-            }
+            dispatch(unit, note_routes[rx[2] & 0x7f], rx[2], rx[3]);
             pass_it_on = true;
             break;
         case 0xB0: // Logic Control 7-segment message or VPot message
-            // CC message
-            success = seven_seg->set_digit_by_mc_cc(rx[2], rx[3]);
-            // filter this out if is a 7-seg LED digit message
-            pass_it_on = !success;
-            if (!success) {
-                for (int chan = 0; !success && chan < num_chan_displays; chan++) {
-                    success = channel_disp[chan]->push_midi_message(rx +1, 3);
-                }
-            }
-            // only push the message if not a display message
-            if (success)
-                pass_it_on = false;
+            // CC message. Only push the message if not a display message
+            pass_it_on = !dispatch(unit, cc_routes[rx[2] & 0x7f], rx[2], rx[3]);
             break;
         case 0xBF: // 7-segment display message alternate
             // Alternate CC message for timecode.
-            success = seven_seg->set_digit_by_mc_cc(rx[2], rx[3]);
             // only push the message if not a display message
-            pass_it_on = !success;
+            pass_it_on = unit.seven_seg == nullptr || !unit.seven_seg->set_digit_by_mc_cc(rx[2], rx[3]);
             break;
         case 0xD0:  // Channel pressure (meter message)
-            for (int chan = 0; !success && chan < num_chan_displays; chan++) {
-                success = channel_disp[chan]->push_midi_message(rx +1, 2);
-            }
             // only push the message if not a display message
-            pass_it_on = !success;
+            pass_it_on = !dispatch(unit, pressure_routes[rx[2] & 0x7f], rx[2], 0);
+            break;
+        case 0xF1: // MIDI Time Code quarter frame
+            // The surface has no use for it
+            mtc.push_quarter_frame(rx[2]);
             break;
         case 0xF0: // sysex start
-            sysex_message[0] = rx[1];
-            sysex_idx = 1;
-            dropped_sysex = 0;
-            for (jdx = 2; jdx < 4 && rx[jdx] != 0xF7; jdx++) {
-                sysex_message[sysex_idx] = rx[jdx];
-                // truncate sysex messages longer than we can store but leave room for EOX
-                if (sysex_idx < max_sysex-1) {
-                    ++sysex_idx;
+            stream.message[0] = rx[1];
+            stream.idx = 1;
+            stream.dropped = 0;
+            stream.lcd_text = false;
+            stream.waiting_for_eox = true;
+            pass_it_on = push_sysex_bytes(cable, rx+2, 2);
+            break;
+        default:
+            if ((rx[1] & 0xF0) == 0xE0) {
+                // Pitch bend (fader position). Channels 1-8 are the channel strip
+                // faders and channel 9 is the master fader. Pass it on for the motor faders.
+                uint8_t fader = rx[1] & 0xF;
+                if (fader < unit.num_strips) {
+                    unit.strips[fader]->set_fader_by_pitch_bend(rx[2], rx[3]);
                 }
-                else {
-                    ++dropped_sysex;
+                else if (fader == 8 && unit.seven_seg != nullptr) {
+                    unit.seven_seg->set_master_fader_by_pitch_bend(rx[2], rx[3]);
                 }
+                pass_it_on = true;
             }
-            if (jdx == 4) {
-                waiting_for_eox = true;
+            else if (stream.waiting_for_eox && (rx[1] < 0x80 || rx[1] == 0xF7)) {
+                // the middle or the tail end of a sysex message
+                pass_it_on = push_sysex_bytes(cable, rx+1, 3);
             }
             else {
-                // must have found eox
-                sysex_message[sysex_idx] = rx[jdx]; // copy eox
-                if (dropped_sysex != 0) {
-                    TU_LOG1("Warning dropped %d sysex bytes\r\n", dropped_sysex);
-                }
-                if (!handle_mc_device_inquiry()) {
-                    if (!seven_seg->set_digits_by_mc_sysex(sysex_message, sysex_idx+1)) {
-                        int nsuccessful = 0;
-                        // have to try every channel strip
-                        for (int chan = 0; chan < num_chan_displays; chan++) {
-                            if (channel_disp[chan]->push_midi_message(sysex_message, sysex_idx+1)) {
-                                ++nsuccessful;
-                            }
-                        }
-                        success = nsuccessful != 0;
-                    }
-                    if (!success) {
-                        // send it on over the MIDI UART
-                        pass_it_on = true;;
-
-                        printf("unhandled:\r\n");
-                        for (size_t kdx=0; kdx<=sysex_idx;kdx++) {
-                            printf("%02x ", sysex_message[kdx]);
-                        }
-                        printf("\n\r");
-                    }
-                }
-                waiting_for_eox = false;
-                sysex_idx = 0;
+                // Just an unhandled message. Pass it on for the host
+                pass_it_on = true;
             }
             break;
-        case 0xF7: // EOX
-            if (waiting_for_eox) {
-                if (dropped_sysex != 0) {
-                    TU_LOG1("Warning dropped %d sysex bytes\r\n", dropped_sysex);
-                }
+    }
+    return pass_it_on;
+}
 
-                sysex_message[sysex_idx] = rx[1];
-                waiting_for_eox = false;
-                if (!handle_mc_device_inquiry()) {
-                    if (!seven_seg->set_digits_by_mc_sysex(sysex_message, sysex_idx+1)) {
-                        // have to try every channel strip
-                        int nsuccessful = 0;
-                        for (int chan = 0; chan < num_chan_displays; chan++) {
-                            if (channel_disp[chan]->push_midi_message(sysex_message, sysex_idx+1)) {
-                                ++nsuccessful;
-                            }
-                        }
-                        success = nsuccessful != 0;
-                    }
-                    if (!success) {
-                        pass_it_on = true; // send it on to the MIDI UART
-                        printf("unhandled:\r\n");
-                        for (size_t kdx=0; kdx<=sysex_idx;kdx++) {
-                            printf("%02x ",sysex_message[kdx]);
-                        }
-                        printf("\n\r");
-                    }
-                }
+bool rppicomidi::Midi_processor_mc_display_core::push_sysex_bytes(uint8_t cable, const uint8_t* bytes, int nbytes)
+{
+    bool pass_it_on = false;
+    Sysex_stream& stream = sysex_streams[cable];
+    Mc_unit& unit = units[cable_unit[cable]];
+    for (int idx = 0; stream.waiting_for_eox && idx < nbytes; idx++) {
+        uint8_t byte = bytes[idx];
+        if (byte == 0xF7) {
+            pass_it_on = end_sysex(cable);
+        }
+        else if (byte & 0x80) {
+            // Something is very wrong. USB doesn't support inserting messages mid-stream
+            stream.waiting_for_eox = false;
+        }
+        else if (stream.lcd_text) {
+            if (stream.lcd_pos < Mc_lcd_model::num_chars) {
+                unit.lcd_model.set_char(stream.lcd_pos++, byte);
             }
-            waiting_for_eox = false;
-            sysex_idx = 0;
-            break;
-        default:
-            if (waiting_for_eox) {
-                // Might be the middle of a sysex message or the tail end of one
-                for (jdx = 1; jdx < 4 && (rx[jdx] & 0x80) == 0; jdx++) {
-                    sysex_message[sysex_idx++] = rx[jdx];
-                }
-                if (jdx < 4) {
-                    if (rx[jdx] == 0xF7) {
-                        // we have the sysex whole message message
-                        if (dropped_sysex != 0) {
-                            TU_LOG1("Warning dropped %d sysex bytes\r\n", dropped_sysex);
-                        }
-
-                        sysex_message[sysex_idx] = 0xF7;
-                        waiting_for_eox = false;
-                        if (!handle_mc_device_inquiry()) {
-                            if (!seven_seg->set_digits_by_mc_sysex(sysex_message, sysex_idx+1)) {
-                                // have to try every channel strip
-                                int nsuccessful = 0;
-                                for (int chan = 0; chan < num_chan_displays; chan++) {
-                                    if (channel_disp[chan]->push_midi_message(sysex_message, sysex_idx+1)) {
-                                        ++nsuccessful;
-                                    }
-                                }
-                                success = nsuccessful != 0;
-                            }
-                            if (!success) {
-                                pass_it_on = true; // send it on to the MIDI UART
-                                printf("unhandled:\r\n");
-                                for (size_t kdx=0; kdx<=sysex_idx;kdx++) {
-                                    printf("%02x ",sysex_message[kdx]);
-                                }
-                                printf("\n\r");
-                            }
-                        }
-                    }
-                    else
-                    {
-                        // Something is very wrong. USB doesn't support inserting messages mid-stream
-                    }
-                    waiting_for_eox = false;
-                    sysex_idx = 0;
-                }
+        }
+        else {
+            // truncate sysex messages longer than we can store but leave room for EOX
+            if (stream.idx < max_sysex-1) {
+                stream.message[stream.idx++] = byte;
             }
             else {
-                // Just an unhandled message. Pass it on for the host
-                pass_it_on = true;
+                ++stream.dropped;
             }
-            break;
+            // F0 00 00 66 14|15 12 oo: the rest of the message is LCD text starting at offset oo
+            const uint8_t* sysex_message = stream.message;
+            if (stream.idx == 7 && sysex_message[1]==0x00 && sysex_message[2]==0x00 && sysex_message[3]==0x66 &&
+                    sysex_message[4]==unit.device_id && sysex_message[5]==0x12) {
+                stream.lcd_text = true;
+                stream.lcd_start = sysex_message[6];
+                stream.lcd_pos = stream.lcd_start;
+                unit.lcd_model.begin_message();
+            }
+        }
+    }
+    return pass_it_on;
+}
+
+bool rppicomidi::Midi_processor_mc_display_core::end_sysex(uint8_t cable)
+{
+    bool pass_it_on = false;
+    Sysex_stream& stream = sysex_streams[cable];
+    Mc_unit& unit = units[cable_unit[cable]];
+    stream.waiting_for_eox = false;
+    if (stream.lcd_text) {
+        // already displayed the whole message
+        stream.lcd_text = false;
+        unit.lcd_model.end_message();
+        if (unit.bank_shift_pending && stream.lcd_start == 0 && stream.lcd_pos >= Mc_bank_cache::name_length)
+            finish_bank_shift(unit);
+        return pass_it_on;
+    }
+    if (stream.dropped != 0) {
+        TU_LOG1("Warning dropped %d sysex bytes\r\n", stream.dropped);
+    }
+    stream.message[stream.idx] = 0xF7; // copy eox
+    if (mtc.push_full_frame(stream.message, stream.idx+1)) {
+        return pass_it_on;
+    }
+    if (!handle_mc_device_inquiry(cable_unit[cable]) && !handle_mc_meter_mode(cable_unit[cable]) &&
+            !handle_xtouch_scribble_colors(cable_unit[cable]) &&
+            (unit.seven_seg == nullptr || !unit.seven_seg->set_digits_by_mc_sysex(stream.message, stream.idx+1))) {
+        // send it on over the MIDI UART
+        pass_it_on = true;
+        printf("unhandled:\r\n");
+        for (size_t kdx=0; kdx<=stream.idx;kdx++) {
+            printf("%02x ", stream.message[kdx]);
+        }
+        printf("\n\r");
     }
     return pass_it_on;
 }
 
-bool rppicomidi::Midi_processor_mc_display_core::handle_mc_device_inquiry()
+void rppicomidi::Midi_processor_mc_display_core::process_surface_packet(const uint8_t* packet)
 {
-    int nread = sysex_idx+1;
+    uint8_t const cable = (packet[0] >> 4) & 0xf;
+    if (cable_unit[cable] == no_unit)
+        return;
+    if (packet[1] != 0x90 || packet[3] == 0)
+        return; // only button presses are of interest
+    Mc_unit& unit = units[cable_unit[cable]];
+    switch (packet[2]) {
+        case 0x34: // NAME/VALUE
+            unit.lcd_model.toggle_page();
+            break;
+        case 0x2E: // BANK LEFT
+            start_bank_shift(unit);
+            break;
+        case 0x2F: // BANK RIGHT
+            start_bank_shift(unit);
+            break;
+        case 0x30: // CHANNEL LEFT
+            start_bank_shift(unit);
+            break;
+        case 0x31: // CHANNEL RIGHT
+            start_bank_shift(unit);
+            break;
+        default:
+            break;
+    }
+}
+
+void rppicomidi::Midi_processor_mc_display_core::task()
+{
+    for (auto& unit: units) {
+        if (unit.in_use)
+            unit.lcd_model.task();
+    }
+    Mc_seven_seg_display* seven_seg = units[0].seven_seg;
+    if (seven_seg == nullptr)
+        return;
+    bool active = mtc.is_active();
+    seven_seg->set_mtc_active(active);
+    if (mtc.task() && active) {
+        uint8_t hours, minutes, seconds, frames;
+        mtc.get_time(hours, minutes, seconds, frames);
+        seven_seg->set_timecode(hours, minutes, seconds, frames);
+    }
+}
+
+void rppicomidi::Midi_processor_mc_display_core::build_routing_tables()
+{
+    for (int idx = 0; idx < 128; idx++) {
+        note_routes[idx] = {Route_field::None, 0};
+        cc_routes[idx] = {Route_field::None, 0};
+        pressure_routes[idx] = {Route_field::None, 0};
+    }
+    note_routes[0x71] = {Route_field::Smpte_beats, 0};
+    note_routes[0x72] = {Route_field::Smpte_beats, 0};
+    for (int idx = 0x40; idx < 0x50; idx++) {
+        cc_routes[idx] = {Route_field::Seven_seg, 0};
+    }
+    // One Mackie Control unit addresses at most 8 channel strips
+    for (uint8_t strip = 0; strip < 8; strip++) {
+        note_routes[strip] = {Route_field::Rec, strip};
+        note_routes[strip + 0x08] = {Route_field::Solo, strip};
+        note_routes[strip + 0x10] = {Route_field::Mute, strip};
+        note_routes[strip + 0x18] = {Route_field::Sel, strip};
+        cc_routes[strip + 0x30] = {Route_field::Vpot, strip};
+        // channel pressure data byte is 0ccc vvvv, where ccc is the strip
+        for (uint8_t value = 0; value < 16; value++) {
+            pressure_routes[(strip << 4) | value] = {Route_field::Meter, strip};
+        }
+    }
+}
+
+bool rppicomidi::Midi_processor_mc_display_core::dispatch(Mc_unit& unit, const Route& route, uint8_t byte1, uint8_t byte2)
+{
+    Mc_channel_strip_display* strip = route.strip < unit.num_strips ? unit.strips[route.strip] : nullptr;
+    switch (route.field) {
+        case Route_field::None:
+            return false;
+        case Route_field::Rec:
+            unit.fresh_leds[route.strip] |= rec_led;
+            set_led(unit, route.strip, rec_led, byte2 != 0);
+            break;
+        case Route_field::Solo:
+            unit.fresh_leds[route.strip] |= solo_led;
+            set_led(unit, route.strip, solo_led, byte2 != 0);
+            break;
+        case Route_field::Mute:
+            unit.fresh_leds[route.strip] |= mute_led;
+            set_led(unit, route.strip, mute_led, byte2 != 0);
+            break;
+        case Route_field::Sel:
+            unit.fresh_leds[route.strip] |= sel_led;
+            set_led(unit, route.strip, sel_led, byte2 != 0);
+            break;
+        case Route_field::Vpot:
+            unit.fresh_vpots |= 1u << route.strip;
+            unit.vpot[route.strip] = byte2;
+            if (strip)
+                strip->set_vpot_by_cc_value(byte2);
+            break;
+        case Route_field::Meter:
+            if (strip)
+                strip->set_meter_by_channel_pressure(byte1);
+            break;
+        case Route_field::Seven_seg:
+            // extender units have no 7-segment displays
+            if (unit.seven_seg == nullptr)
+                return false;
+            unit.seven_seg->set_digit_by_mc_cc(byte1, byte2);
+            break;
+        case Route_field::Smpte_beats:
+            if (unit.seven_seg == nullptr)
+                return false;
+            unit.seven_seg->set_smpte_beats_by_mc_note(byte1, byte2);
+            break;
+    }
+    return true;
+}
+
+void rppicomidi::Midi_processor_mc_display_core::set_led(Mc_unit& unit, uint8_t strip_idx, uint8_t led, bool is_on)
+{
+    if (is_on)
+        unit.leds[strip_idx] |= led;
+    else
+        unit.leds[strip_idx] &= ~led;
+    if (strip_idx < unit.num_strips) {
+        Mc_channel_strip_display* strip = unit.strips[strip_idx];
+        switch (led) {
+            case rec_led:
+                strip->set_rec(is_on);
+                break;
+            case solo_led:
+                strip->set_solo(is_on);
+                break;
+            case mute_led:
+                strip->set_mute(is_on);
+                break;
+            case sel_led:
+                strip->set_sel(is_on);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void rppicomidi::Midi_processor_mc_display_core::start_bank_shift(Mc_unit& unit)
+{
+    if (!unit.lcd_model.is_name_page())
+        return; // the cache is keyed by track name; values do not identify a bank
+    if (!unit.bank_shift_pending) {
+        // Save the bank that is shown only once; later presses before the
+        // LCD update would save the next bank's state under this name
+        Mc_bank_cache::Snapshot snapshot;
+        memcpy(snapshot.vpot, unit.vpot, sizeof(snapshot.vpot));
+        memcpy(snapshot.leds, unit.leds, sizeof(snapshot.leds));
+        memcpy(unit.shift_name, unit.lcd_model.get_chars(), sizeof(unit.shift_name));
+        unit.bank_cache.save(unit.shift_name, snapshot);
+        unit.bank_shift_pending = true;
+    }
+    unit.fresh_vpots = 0;
+    memset(unit.fresh_leds, 0, sizeof(unit.fresh_leds));
+}
+
+void rppicomidi::Midi_processor_mc_display_core::finish_bank_shift(Mc_unit& unit)
+{
+    unit.bank_shift_pending = false;
+    if (!unit.lcd_model.is_name_page())
+        return; // NAME/VALUE was pressed during the shift
+    const uint8_t* name = unit.lcd_model.get_chars();
+    if (memcmp(name, unit.shift_name, sizeof(unit.shift_name)) == 0)
+        return; // the DAW did not shift the bank
+    const Mc_bank_cache::Snapshot* cached = unit.bank_cache.find(name);
+    if (!cached)
+        return;
+    // Show the rest of the new bank now. Messages from the DAW correct anything that changed
+    for (uint8_t strip = 0; strip < 8; strip++) {
+        if ((unit.fresh_vpots & (1u << strip)) == 0) {
+            unit.vpot[strip] = cached->vpot[strip];
+            if (strip < unit.num_strips)
+                unit.strips[strip]->set_vpot_by_cc_value(cached->vpot[strip]);
+        }
+        for (uint8_t led = rec_led; led <= sel_led; led <<= 1) {
+            if ((unit.fresh_leds[strip] & led) == 0)
+                set_led(unit, strip, led, (cached->leds[strip] & led) != 0);
+        }
+    }
+}
+
+void rppicomidi::Midi_processor_mc_display_core::set_strip_bank(uint8_t bank, uint8_t num_strips, Mc_channel_strip_display **strips)
+{
+    assert(bank < max_units);
+    if (num_strips > 8)
+        num_strips = 8;
+    units[bank].num_strips = num_strips;
+    units[bank].strips = strips;
+    units[bank].lcd_model.set_channel_strips(num_strips, strips);
+}
+
+bool rppicomidi::Midi_processor_mc_display_core::add_unit(uint8_t cable)
+{
+    if (cable > 15)
+        return false;
+    if (cable_unit[cable] != no_unit) {
+        // already have one; e.g., the MC Display processor is on both the IN and OUT chain
+        ++units[cable_unit[cable]].nusers;
+        return true;
+    }
+    uint8_t unit_idx = 0;
+    if (units[0].in_use) {
+        for (unit_idx = 1; unit_idx < max_units && units[unit_idx].in_use; unit_idx++) {
+        }
+        if (unit_idx >= max_units) {
+            printf("No more MC extender units available for cable %u\r\n", cable);
+            return false;
+        }
+    }
+    Mc_unit& unit = units[unit_idx];
+    reset_unit(unit);
+    unit.in_use = true;
+    unit.nusers = 1;
+    unit.cable = cable;
+    unit.device_id = unit_idx == 0 ? mcu_device_id : xt_device_id;
+    cable_unit[cable] = unit_idx;
+    sysex_streams[cable].waiting_for_eox = false;
+    if (unit_idx == 0 && cable_cb) {
+        cable_cb(cable, set_cable_context);
+    }
+    return true;
+}
+
+void rppicomidi::Midi_processor_mc_display_core::remove_unit(uint8_t cable)
+{
+    if (cable < 16 && cable_unit[cable] != no_unit) {
+        Mc_unit& unit = units[cable_unit[cable]];
+        if (--unit.nusers == 0) {
+            unit.in_use = false;
+            cable_unit[cable] = no_unit;
+        }
+    }
+}
+
+void rppicomidi::Midi_processor_mc_display_core::reset_unit(Mc_unit& unit)
+{
+    uint8_t num_strips = unit.num_strips;
+    Mc_channel_strip_display **strips = unit.strips;
+    Mc_seven_seg_display* seven_seg = unit.seven_seg;
+    unit = Mc_unit{};
+    unit.num_strips = num_strips;
+    unit.strips = strips;
+    unit.seven_seg = seven_seg;
+    unit.lcd_model.set_channel_strips(num_strips, strips);
+    for (uint8_t idx = 0; idx < num_strips; idx++) {
+        strips[idx]->set_rec(false);
+        strips[idx]->set_solo(false);
+        strips[idx]->set_mute(false);
+        strips[idx]->set_sel(false);
+        strips[idx]->set_vpot_by_cc_value(0);
+    }
+}
+
+bool rppicomidi::Midi_processor_mc_display_core::handle_mc_device_inquiry(uint8_t unit_idx)
+{
+    const Mc_unit& unit = units[unit_idx];
+    uint8_t cable = unit.cable;
+    const uint8_t* sysex_message = sysex_streams[cable].message;
+    int nread = sysex_streams[cable].idx+1;
     bool handled = false;
+    // Each unit needs its own serial number
+    uint8_t unit_serial_number[7];
+    memcpy(unit_serial_number, serial_number, sizeof(unit_serial_number));
+    unit_serial_number[0] = (unit_serial_number[0] + unit_idx) & 0x7F;
     if (nread==7 && sysex_message[1]==0x00 && sysex_message[2]==0x00 && sysex_message[3]==0x66 &&
-        sysex_message[4]==0x14 && sysex_message[5]==0x00 && sysex_message[6] == 0xf7) {
+        sysex_message[4]==unit.device_id && sysex_message[5]==0x00 && sysex_message[6] == 0xf7) {
         // MC device query message; respond with the MC Host Connection Query
         uint8_t host_connection_query[]= { 0xF0, // start sysex
             0x00, 0x00, 0x66, // Mackie Manufacturer ID
-            0x14, // MCU Pro (0x14) with all displays
+            unit.device_id, // MCU Pro (0x14) with all displays or extender (0x15)
             0x01, // Host Connection Query message ID
-            serial_number[0], serial_number[1], serial_number[2], serial_number[3], serial_number[4], serial_number[5], serial_number[6], // arbitrary serial number
+            unit_serial_number[0], unit_serial_number[1], unit_serial_number[2], unit_serial_number[3], unit_serial_number[4], unit_serial_number[5], unit_serial_number[6], // arbitrary serial number
             0x01, 0x02, 0x03, 0x04, // arbitray
             0xf7, // EOX
         };
-        uint32_t nwritten = tud_midi_stream_write(cable_num, host_connection_query, sizeof(host_connection_query));
+        uint32_t nwritten = tud_midi_stream_write(cable, host_connection_query, sizeof(host_connection_query));
         if (nwritten != sizeof(host_connection_query)) {
             TU_LOG1("Warning: Dropped %lu bytes of host_connection_query message\r\n", sizeof(host_connection_query) - nwritten);
         }
@@ -253,15 +465,15 @@ bool rppicomidi::Midi_processor_mc_display_core::handle_mc_device_inquiry()
         handled = true;
     }
     else if (nread==8 && sysex_message[1]==0x00 && sysex_message[2]==0x00 && sysex_message[3]==0x66 &&
-        sysex_message[4]==0x14 && sysex_message[5]==0x1A && sysex_message[6] == 0x00 && sysex_message[7] == 0xf7) {
+        sysex_message[4]==unit.device_id && sysex_message[5]==0x1A && sysex_message[6] == 0x00 && sysex_message[7] == 0xf7) {
         uint8_t serial_number_response[] = { 0xF0, // start sysex
             0x00, 0x00, 0x66, // Mackie Manufacturer ID
-            0x14, // MCU Pro
+            unit.device_id, // MCU Pro or extender
             0x1B, 0x58, 0x59, 0x5A, // Response to serial number request
-            serial_number[0], serial_number[1], serial_number[2], serial_number[3], // The serial number
+            unit_serial_number[0], unit_serial_number[1], unit_serial_number[2], unit_serial_number[3], // The serial number
             0xF7 // EOX
         };
-        uint32_t nwritten = tud_midi_stream_write(cable_num, serial_number_response, sizeof(serial_number_response));
+        uint32_t nwritten = tud_midi_stream_write(cable, serial_number_response, sizeof(serial_number_response));
         if (nwritten != sizeof(serial_number_response)) {
             TU_LOG1("Warning: Dropped %lu bytes of serial_number_response message\r\n", sizeof(serial_number_response) - nwritten);
         }
@@ -270,13 +482,56 @@ bool rppicomidi::Midi_processor_mc_display_core::handle_mc_device_inquiry()
         }
         handled = true;
     }
-    else if (nread >= 6 && sysex_message[1]==0x00 && sysex_message[2]==0x00 && sysex_message[3]==0x66 && sysex_message[4]==0x15) {
-        // message is for an extender. Ignore it
+    else if (nread >= 6 && sysex_message[1]==0x00 && sysex_message[2]==0x00 && sysex_message[3]==0x66 &&
+            (sysex_message[4]==mcu_device_id || sysex_message[4]==xt_device_id) && sysex_message[4]!=unit.device_id) {
+        // message is for the other kind of MC unit. Ignore it
         handled = true;
     }
     return handled;
 }
 
+bool rppicomidi::Midi_processor_mc_display_core::handle_mc_meter_mode(uint8_t unit_idx)
+{
+    Mc_unit& unit = units[unit_idx];
+    const uint8_t* sysex_message = sysex_streams[unit.cable].message;
+    int nread = sysex_streams[unit.cable].idx+1;
+    if (nread < 8 || sysex_message[1]!=0x00 || sysex_message[2]!=0x00 || sysex_message[3]!=0x66 ||
+            sysex_message[4]!=unit.device_id) {
+        return false;
+    }
+    if (nread==9 && sysex_message[5]==0x20) {
+        // channel meter mode
+        uint8_t strip = sysex_message[6];
+        if (strip < unit.num_strips) {
+            unit.strips[strip]->set_meter_mode(sysex_message[7]);
+        }
+        return true;
+    }
+    if (nread==8 && sysex_message[5]==0x21) {
+        // global LCD meter mode. The strip displays only have vertical meters
+        // but keep track of it anyway.
+        unit.vertical_meters = sysex_message[6] != 0;
+        return true;
+    }
+    return false;
+}
+
+bool rppicomidi::Midi_processor_mc_display_core::handle_xtouch_scribble_colors(uint8_t unit_idx)
+{
+    Mc_unit& unit = units[unit_idx];
+    const uint8_t* sysex_message = sysex_streams[unit.cable].message;
+    int nread = sysex_streams[unit.cable].idx+1;
+    // F0 00 00 66 14|15 72 c1 c2 c3 c4 c5 c6 c7 c8 F7: one color per strip
+    if (nread != 15 || sysex_message[1]!=0x00 || sysex_message[2]!=0x00 || sysex_message[3]!=0x66 ||
+            sysex_message[4]!=unit.device_id || sysex_message[5]!=0x72) {
+        return false;
+    }
+    for (int strip = 0; strip < 8 && strip < unit.num_strips; strip++) {
+        unit.strips[strip]->set_scribble_color(sysex_message[6+strip]);
+    }
+    return true;
+}
+
 void rppicomidi::Midi_processor_mc_display_core::create_serial_number()
 {
     uint64_t now = time_us_64();
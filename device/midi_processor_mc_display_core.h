@@ -22,8 +22,12 @@
  * SOFTWARE.
  */
 #pragma once
+#include <cstring>
 #include "mc_seven_seg_display.h"
 #include "mc_channel_strip_display.h"
+#include "mc_lcd_model.h"
+#include "mc_mtc_decoder.h"
+#include "mc_bank_cache.h"
 namespace rppicomidi
 {
 class Midi_processor_mc_display_core
@@ -55,32 +59,269 @@ public:
      * @param seven_seg_ a pointer to the 7-segment display View
      */
     void init(uint8_t num_chan_displays_, Mc_channel_strip_display **channel_disp_, Mc_seven_seg_display* seven_seg_) {
-        num_chan_displays = num_chan_displays_;
-        channel_disp = channel_disp_;
-        seven_seg = seven_seg_;
+        set_strip_bank(0, num_chan_displays_, channel_disp_);
+        units[0].seven_seg = seven_seg_;
     }
+
+    /**
+     * @brief attach the channel strips that display one MC unit
+     *
+     * @param bank 0 for the main unit; 1 to max_units-1 for the extender units
+     * in the order they are added
+     * @param num_strips the number of channel strips; an MC unit has at most 8
+     * @param strips an array of num_strips Mc_channel_strip_display pointers
+     *
+     * @note the bridge passes the traffic of a unit without a strip bank
+     * through unchanged so that another device can show it
+     */
+    void set_strip_bank(uint8_t bank, uint8_t num_strips, Mc_channel_strip_display **strips);
+
     bool process(uint8_t* packet);
+
+    /**
+     * @brief Look at a packet from the control surface before it is sent to the DAW
+     *
+     * Pressing the NAME/VALUE button (note 0x34) switches the channel strip text
+     * page right away instead of waiting for the DAW to resend the LCD text.
+     * Pressing a bank or channel shift button (notes 0x2E-0x31) saves the strip
+     * state of the current bank. When the DAW's LCD update shows a different
+     * first track name, the cached VPot and LED state of that bank, if any, is
+     * shown until the DAW sends the real state.
+     * @param packet the USB MIDI packet from the surface
+     */
+    void process_surface_packet(const uint8_t* packet);
+
+    /**
+     * @brief advance the MIDI Time Code clock, update the Timecode display
+     * and expire unconfirmed NAME/VALUE page toggles. Call once per render cycle.
+     */
+    void task();
     void create_serial_number();
 
-    void set_cable(uint8_t cable_) { cable_num = cable_; if (cable_cb) cable_cb(cable_, set_cable_context); }
+    /**
+     * @brief make the bridge act as an MC unit on a virtual cable
+     *
+     * The first unit added is the main (MCU) unit. It owns strip bank 0 and the
+     * 7-segment display, and the set cable callback reports its cable. Units
+     * added while the main unit exists are extender (XT) units that use the
+     * next free strip bank. Adding a cable that already has a unit counts one
+     * more user of that unit; a new unit starts from a clean state.
+     *
+     * @param cable the virtual cable number 0-15
+     * @return true if the cable has an MC unit
+     */
+    bool add_unit(uint8_t cable);
+
+    /**
+     * @brief stop acting as an MC unit on a virtual cable
+     *
+     * The unit stays in use until every add_unit() call for the cable has
+     * a matching remove_unit() call.
+     *
+     * @param cable the virtual cable number 0-15
+     */
+    void remove_unit(uint8_t cable);
+
+    /**
+     * @brief check if the bridge acts as an MC unit on a virtual cable
+     *
+     * @param cable the virtual cable number 0-15
+     * @return true if the cable has an MC unit
+     */
+    bool has_unit(uint8_t cable) const { return cable_unit[cable & 0xF] != no_unit; }
     void register_set_cable_callback(void (*cable_cb_)(uint8_t, void*), void* context_) {cable_cb =cable_cb_; set_cable_context = context_; }
+
+    static const uint8_t max_units = 4; // one MCU plus up to 3 extenders
 private:
     Midi_processor_mc_display_core() :
-            num_chan_displays{0}, channel_disp{nullptr}, seven_seg{nullptr}, sysex_idx{0}, waiting_for_eox{false}, cable_cb{nullptr}, set_cable_context{nullptr}
+            cable_cb{nullptr}, set_cable_context{nullptr}
     {
         create_serial_number(); // make sure the serial_number variable is valid;
+        memset(cable_unit, no_unit, sizeof(cable_unit));
+        build_routing_tables();
     }
-    bool handle_mc_device_inquiry();
-    uint8_t num_chan_displays;
-    Mc_channel_strip_display **channel_disp;
-    Mc_seven_seg_display* seven_seg;
-    static const size_t max_sysex = 2048; // the maximum MC SySex message is 120 bytes long, but fortune favors the prepared
-    uint8_t sysex_message[max_sysex];
-    size_t sysex_idx;  // the index into the sysex_message array
-    bool waiting_for_eox;
+
+    static const uint8_t mcu_device_id = 0x14;
+    static const uint8_t xt_device_id = 0x15;
+    static const uint8_t no_unit = 0xFF;
+    /**
+     * @brief The state of one emulated MC unit. Each unit has its own
+     * channel strip bank and LCD model.
+     */
+    struct Mc_unit {
+        Mc_unit() : in_use{false}, nusers{0}, cable{0}, device_id{mcu_device_id}, num_strips{0}, strips{nullptr}, seven_seg{nullptr},
+            vertical_meters{false}, vpot{0}, leds{0},
+            bank_shift_pending{false}, shift_name{0}, fresh_vpots{0}, fresh_leds{0} {}
+        bool in_use;
+        uint8_t nusers;     // the number of processors (IN and OUT chain) that added the unit
+        uint8_t cable;      // the virtual cable the unit uses
+        uint8_t device_id;  // mcu_device_id or xt_device_id
+        uint8_t num_strips;
+        Mc_channel_strip_display **strips;
+        Mc_seven_seg_display* seven_seg; // nullptr for extender units
+        Mc_lcd_model lcd_model;
+        bool vertical_meters; // from the global LCD meter mode message
+        uint8_t vpot[8];    // the last VPot LED ring CC values
+        uint8_t leds[8];    // the last REC, SOLO, MUTE and SEL LED bits
+        Mc_bank_cache bank_cache;
+        bool bank_shift_pending; // a bank or channel button was pressed; waiting for the DAW's LCD update
+        uint8_t shift_name[Mc_bank_cache::name_length]; // the first track name when the button was pressed
+        uint8_t fresh_vpots;    // bit n is set if the DAW sent strip n's VPot ring since the button press
+        uint8_t fresh_leds[8];  // the LED bits the DAW sent for each strip since the button press
+    };
+
+    static const uint8_t rec_led = 0x1;
+    static const uint8_t solo_led = 0x2;
+    static const uint8_t mute_led = 0x4;
+    static const uint8_t sel_led = 0x8;
+
+    /**
+     * @brief record the LED state for bank snapshots and show it on the strip
+     */
+    void set_led(Mc_unit& unit, uint8_t strip_idx, uint8_t led, bool is_on);
+
+    /**
+     * @brief forget everything a previous user of the unit set
+     *
+     * The strip bank and 7-segment display stay attached.
+     */
+    void reset_unit(Mc_unit& unit);
+
+    /**
+     * @brief save the current strip state of a unit to the bank cache, keyed
+     * by the first track name, and wait for the DAW to show the new bank
+     *
+     * Only the first press before the DAW's LCD update saves; nothing is
+     * cached while the strips show the VALUE page.
+     *
+     * @param unit the MC unit
+     */
+    void start_bank_shift(Mc_unit& unit);
+
+    /**
+     * @brief called after an LCD message that wrote the first track name.
+     * If the name changed, the DAW shifted the bank; show the cached VPot
+     * and LED state of the new bank for the strips the DAW has not updated yet.
+     * If the name did not change, the DAW did not shift (e.g. at the first or
+     * last bank) and nothing is restored.
+     *
+     * @param unit the MC unit
+     */
+    void finish_bank_shift(Mc_unit& unit);
+    /**
+     * @brief respond to MC device query and serial number request messages
+     *
+     * @param unit_idx the index of the unit the message is for
+     * @return true if the message in the unit cable's sysex stream was handled
+     */
+    bool handle_mc_device_inquiry(uint8_t unit_idx);
+
+    /**
+     * @brief apply MC channel meter mode (F0 00 00 66 14 20 0i 0m F7) and
+     * global LCD meter mode (F0 00 00 66 14 21 0m F7) messages
+     *
+     * The surface does not display meters, so these messages are always consumed.
+     * @param unit_idx the index of the unit the message is for
+     * @return true if the message in the unit cable's sysex stream was handled
+     */
+    bool handle_mc_meter_mode(uint8_t unit_idx);
+
+    /**
+     * @brief apply the Behringer X-Touch scribble strip color message
+     * (F0 00 00 66 14 72 c0 c1 c2 c3 c4 c5 c6 c7 F7) to the channel text styles
+     *
+     * @param unit_idx the index of the unit the message is for
+     * @return true if the message in the unit cable's sysex stream was handled
+     */
+    bool handle_xtouch_scribble_colors(uint8_t unit_idx);
+
+    /**
+     * @brief decode the data bytes of the sysex message in progress
+     *
+     * LCD text messages are written to the LCD model as the bytes arrive
+     * and changed characters are drawn on the next render cycle; all other messages are buffered
+     * in the cable's sysex stream until EOX.
+     *
+     * @param cable the virtual cable the packet arrived on
+     * @param bytes the bytes from one USB MIDI packet
+     * @param nbytes the maximum number of bytes to decode; decoding stops at EOX
+     * @return true if the message is complete and should be passed on
+     */
+    bool push_sysex_bytes(uint8_t cable, const uint8_t* bytes, int nbytes);
+
+    /**
+     * @brief finish processing the sysex message after EOX
+     *
+     * @param cable the virtual cable the message arrived on
+     * @return true if the message was not handled and should be passed on
+     */
+    bool end_sysex(uint8_t cable);
+
+    /**
+     * @brief The display element that a Note, CC or Channel Pressure
+     * message targets
+     */
+    enum class Route_field : uint8_t {
+        None,       // not a display message
+        Rec,        // channel strip REC LED
+        Solo,       // channel strip SOLO LED
+        Mute,       // channel strip MUTE LED
+        Sel,        // channel strip SELECT LED
+        Vpot,       // channel strip VPot LED ring
+        Meter,      // channel strip meter
+        Seven_seg,  // timecode or assignment 7-segment digit
+        Smpte_beats // SMPTE or BEATS LED
+    };
+    struct Route {
+        Route_field field;
+        uint8_t strip; // the channel strip index for channel strip fields
+    };
+
+    /**
+     * @brief fill the note, CC and channel pressure routing tables.
+     * All units share the tables; the strip field is the strip index
+     * within the unit's strip bank.
+     */
+    void build_routing_tables();
+
+    /**
+     * @brief update the display element of the unit the route points to
+     *
+     * @param unit the MC unit the message is for
+     * @param route the routing table entry for the message
+     * @param byte1 the first data byte of the message
+     * @param byte2 the second data byte of the message (0 for channel pressure)
+     * @return true if the message is a display message for this unit
+     */
+    bool dispatch(Mc_unit& unit, const Route& route, uint8_t byte1, uint8_t byte2);
+    // Routing tables indexed by the first data byte of the message
+    Route note_routes[128];
+    Route cc_routes[128];
+    Route pressure_routes[128];
+    Mc_unit units[max_units];
+    uint8_t cable_unit[16]; // cable_unit[cbl] is the index into units for cable cbl or no_unit
+    // LCD text messages, up to 120 bytes long, are decoded as they arrive. Other MC SysEx messages
+    // are no more than 17 bytes long, but fortune favors the prepared
+    static const size_t max_sysex = 64;
+    /**
+     * @brief The SysEx reassembly state for one virtual cable. Each cable
+     * has its own so SysEx messages interleaved on several cables do not
+     * corrupt each other.
+     */
+    struct Sysex_stream {
+        Sysex_stream() : idx{0}, dropped{0}, waiting_for_eox{false}, lcd_text{false}, lcd_start{0}, lcd_pos{0} {}
+        uint8_t message[max_sysex];
+        size_t idx;       // the index into the message array
+        int dropped;      // the number of bytes of the current message that did not fit in message
+        bool waiting_for_eox;
+        bool lcd_text;    // true if the current message is an LCD text message
+        uint8_t lcd_start; // the LCD position of the first character of the LCD text message
+        uint8_t lcd_pos;  // the LCD position 0-111 for the next character of the LCD text message
+    };
+    Sysex_stream sysex_streams[16];
     uint8_t serial_number[7];
+    Mc_mtc_decoder mtc;
     void (*cable_cb)(uint8_t, void*);
     void* set_cable_context;
-    uint8_t cable_num;
 };
 }
\ No newline at end of file
@@ -25,6 +25,7 @@
 #include "midi_buttons.h"
 #include <cstring>
 #include "../common/pico-mc-display-bridge-cmds.h"
+#include "../common/midi_uart_tx.h"
 rppicomidi::Midi_buttons::Midi_buttons() :
     prev_buttons{0}, previous_timestamp{get_absolute_time()}, cable_num{0}, chan_button_mode{0}
 {
@@ -138,7 +139,7 @@ void rppicomidi::Midi_buttons::poll()
                         tx[2] = 0x0; // button is released
                     }
                     tx[1] = chan + chan_btn_msg[chan_button_mode];
-                    Pico_pico_midi_lib::instance().write_midi_to_tx_buffer(tx, 3, cable_num);
+                    Midi_uart_tx::instance().write(tx, 3, cable_num);
                 }
                 mask <<= 1;
             }
@@ -152,7 +153,7 @@ void rppicomidi::Midi_buttons::poll()
             else {
                 tx[2] = 0x0; // button is released
             }
-            Pico_pico_midi_lib::instance().write_midi_to_tx_buffer(tx, 3, cable_num);
+            Midi_uart_tx::instance().write(tx, 3, cable_num);
         }
         diff = delta & name_value_button;
         if (diff) {
@@ -163,7 +164,7 @@ void rppicomidi::Midi_buttons::poll()
             else {
                 tx[2] = 0x0; // button is released
             }
-            Pico_pico_midi_lib::instance().write_midi_to_tx_buffer(tx, 3, cable_num);
+            Midi_uart_tx::instance().write(tx, 3, cable_num);
         }
     }
 }
\ No newline at end of file
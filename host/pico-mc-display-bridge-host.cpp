@@ -38,6 +38,8 @@
 #include "class/midi/midi_host.h"
 #include "nav_buttons.h"
 #include "midi_buttons.h"
+#include "../common/midi_codec.h"
+#include "../common/midi_uart_tx.h"
 
 namespace rppicomidi
 {
@@ -89,6 +91,7 @@ public:
     void usbh_dev_string_cb(uint8_t dev_addr, uint8_t istring, uint16_t langid, uint8_t num_utf16le, uint16_t* utf16le);
 
     uint8_t midi_dev_addr;
+    Midi_codec::Packetizer rx_packetizer[16]; // rx_packetizer[cbl] decodes the UART MIDI stream for cable number cbl 0-15
 
     static const uint8_t max_string_indices = 255;
     uint8_t all_string_indices[max_string_indices];
@@ -111,9 +114,16 @@ void rppicomidi::Pico_mc_display_bridge_host::midi_cb(uint8_t *buffer, uint8_t b
 {
     if (buflen > 0 && tuh_midih_get_num_tx_cables(instance().midi_dev_addr) >= 1)
     {
-        uint32_t nwritten = tuh_midi_stream_write(instance().midi_dev_addr, cable_num,buffer, buflen);
-        if (nwritten != buflen) {
-            TU_LOG1("Warning: Dropped %lu bytes receiving from UART MIDI In\r\n", buflen - nwritten);
+        // Expand running status and send complete messages
+        uint8_t packet[4];
+        for (uint8_t idx = 0; idx < buflen; idx++) {
+            if (instance().rx_packetizer[cable_num].push(cable_num, buffer[idx], packet)) {
+                uint8_t nbytes = Midi_codec::packet_length(packet[0]);
+                uint32_t nwritten = tuh_midi_stream_write(instance().midi_dev_addr, cable_num, packet+1, nbytes);
+                if (nwritten != nbytes) {
+                    TU_LOG1("Warning: Dropped %lu bytes receiving from UART MIDI In\r\n", nbytes - nwritten);
+                }
+            }
         }
     }
 }
@@ -402,7 +412,7 @@ void tuh_midi_rx_cb(uint8_t dev_addr, uint32_t num_packets)
             uint8_t cable_num;
             uint8_t buffer[48];
             uint32_t bytes_read = tuh_midi_stream_read(dev_addr, &cable_num, buffer, sizeof(buffer));
-            uint8_t npushed = rppicomidi::Pico_pico_midi_lib::instance().write_midi_to_tx_buffer(buffer, bytes_read, cable_num); //rppicomidi::Pico_pico_midi_lib::instance().write_tx_buffer(buffer,bytes_read);
+            uint8_t npushed = rppicomidi::Midi_uart_tx::instance().write(buffer, bytes_read, cable_num);
             if (npushed != bytes_read) {
                 TU_LOG1("Warning: Dropped %lu bytes sending to UART MIDI Out\r\n", bytes_read - npushed);
             }